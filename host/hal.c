@@ -0,0 +1,26 @@
+/*
+ * Host (Linux) build of Mega mruby/c: mruby/c HAL.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * Replaces src/compat.c. The console goes to stderr instead of the screen,
+ * so that the screen only has what the game draws.
+ */
+#include <unistd.h>
+#include <genesis.h>
+#include "host.h"
+
+int hal_write(int fd, const void *buf, int nbytes) {
+  host_console_bytes += nbytes;
+  return write(2, buf, nbytes);
+}
+
+void hal_init(void) {
+}
+
+// the vertical interrupt is called between the tasks, see host/sys.c
+void hal_enable_irq(void) {
+}
+
+void hal_disable_irq(void) {
+}
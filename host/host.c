@@ -0,0 +1,189 @@
+/*
+ * Host (Linux) build of Mega mruby/c: main.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * (usage)
+ * megamrbc [option]
+ *
+ *  -j file    joypad script, see host/sys.c ("-" for stdin)
+ *  -s script  joypad script in the argument
+ *  -n frames  end the run after the frames
+ *  -d dir     write the last frame of each section to dir/label.ppm
+ *
+ * Runs the game of src/ headless, and reports the VDP accesses of each
+ * section of the joypad script when the run ends. The run fails if a task
+ * writes to the console, which it does only for an uncaught exception.
+ */
+#include <time.h>
+#include <unistd.h>
+#include <genesis.h>
+#include "host.h"
+
+// src/main.c, compiled with -Dmain=megamrbc_main
+int megamrbc_main(void);
+
+#define SECTION_MAX 256
+
+static struct SECTION {
+  char label[32];
+  HOST_VDP_STATS stats;
+  u32 host_us;
+} sections[SECTION_MAX];
+static u16 section_count;
+static struct timespec section_start;
+static const char *dump_dir;
+static int dump_failed;
+
+u32 host_console_bytes;
+
+
+static u32 elapsed_us(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - section_start.tv_sec) * 1000000 +
+    (now.tv_nsec - section_start.tv_nsec) / 1000;
+}
+
+static void section_begin(const char *label) {
+  struct SECTION *s = &sections[section_count];
+  snprintf(s->label, sizeof(s->label), "%s", label);
+  memset(&host_vdp_stats, 0, sizeof(host_vdp_stats));
+  clock_gettime(CLOCK_MONOTONIC, &section_start);
+}
+
+static void section_end(void) {
+  struct SECTION *s = &sections[section_count];
+
+  // nothing happened, e.g. the boot before the first mark of the script.
+  if(host_vdp_stats.frames == 0 && host_vdp_stats.calls == 0) return;
+
+  s->stats = host_vdp_stats;
+  s->host_us = elapsed_us();
+  if(section_count < SECTION_MAX - 1) section_count++;
+
+  if(dump_dir) {
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s/%s.ppm", dump_dir, s->label);
+    if(host_screen_write(filename) != 0) {
+      fprintf(stderr, "File can't write. %s\n", filename);
+      dump_failed = 1;
+    }
+  }
+}
+
+// Ends the current section of the report, and begins the next one.
+void host_mark(const char *label) {
+  section_end();
+  section_begin(label);
+}
+
+static void print_section(const char *label, const HOST_VDP_STATS *st, u32 us) {
+  printf("%-16s %6u %6u %8u %8u %7u %6u %6u %5u %9u\n", label,
+         st->frames, st->calls, st->cpu_words, st->dma_bytes, st->dma_peak,
+         st->tile_words / 16, st->map_words, st->cram_words, us);
+}
+
+static void report(void) {
+  HOST_VDP_STATS total = { 0 };
+  u32 total_us = 0;
+  u16 i;
+
+  printf("%-16s %6s %6s %8s %8s %7s %6s %6s %5s %9s\n", "# section",
+         "frames", "calls", "cpu_w", "dma_b", "dma_pk", "tiles", "map_w", "cram", "host_us");
+  for(i = 0; i < section_count; i++) {
+    const HOST_VDP_STATS *st = &sections[i].stats;
+    print_section(sections[i].label, st, sections[i].host_us);
+
+    total.frames += st->frames;
+    total.calls += st->calls;
+    total.cpu_words += st->cpu_words;
+    total.dma_bytes += st->dma_bytes;
+    if(st->dma_peak > total.dma_peak) total.dma_peak = st->dma_peak;
+    total.tile_words += st->tile_words;
+    total.map_words += st->map_words;
+    total.cram_words += st->cram_words;
+    total_us += sections[i].host_us;
+  }
+  print_section("# total", &total, total_us);
+}
+
+// Ends the run. An uncaught exception is a failure.
+void host_exit(int status) {
+  section_end();
+  report();
+  fflush(stdout);
+  if(status == 0 && (host_console_bytes > 0 || dump_failed)) status = 1;
+  exit(status);
+}
+
+static char *read_file(const char *filename) {
+  FILE *fp = (strcmp(filename, "-") == 0) ? stdin : fopen(filename, "r");
+  if(!fp) return NULL;
+
+  size_t size = 0, capacity = 4096;
+  char *buf = malloc(capacity);
+  size_t n;
+  while((n = fread(buf + size, 1, capacity - size - 1, fp)) > 0) {
+    size += n;
+    if(capacity - size == 1) buf = realloc(buf, capacity *= 2);
+  }
+  buf[size] = '\0';
+  if(fp != stdin) fclose(fp);
+  return buf;
+}
+
+static void usage(void) {
+  fprintf(stderr, "Usage: megamrbc [-j script_file] [-s script] [-n frames] [-d dir]\n");
+}
+
+int main(int argc, char *argv[]) {
+  const char *script = NULL;
+  int opt;
+
+  while((opt = getopt(argc, argv, "j:s:n:d:h")) != -1) {
+    switch(opt) {
+    case 'j':
+      script = read_file(optarg);
+      if(!script) {
+        fprintf(stderr, "File can't open. %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 's':
+      script = optarg;
+      break;
+    case 'n':
+      host_frame_limit = strtoul(optarg, NULL, 10);
+      break;
+    case 'd':
+      dump_dir = optarg;
+      break;
+    default:
+      usage();
+      return 1;
+    }
+  }
+  if(!script && !host_frame_limit) {
+    usage();
+    return 1;
+  }
+  if(script) {
+    int line = host_joy_script(script);
+    if(line) {
+      fprintf(stderr, "joypad script: syntax error in line %d.\n", line);
+      return 1;
+    }
+  }
+
+  host_vdp_init();
+  host_sprite_init();
+  section_begin("boot");
+  if(script) host_joy_start();
+
+  megamrbc_main();
+
+  // the game never ends: all the tasks have died.
+  host_exit(1);
+  return 1;
+}
@@ -0,0 +1,70 @@
+/*
+ * Host (Linux) build of Mega mruby/c: the emulated hardware.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * The SGDK functions of host/inc/genesis.h write to this model of the VDP
+ * memory. Nothing is displayed: the model is for counting the VDP accesses
+ * of the game, and for composing the screen into image files.
+ */
+#ifndef MEGAMRBC_HOST_HOST_H_
+#define MEGAMRBC_HOST_HOST_H_
+
+#include <genesis.h>
+
+#define PLANE_WIDTH     64      // in tiles
+#define PLANE_HEIGHT    32
+#define SCREEN_WIDTH    320     // in pixels
+#define SCREEN_HEIGHT   224
+
+// VDP memory.
+typedef struct {
+  u16 vram[0x8000];     // by word
+  u16 cram[64];
+  u8 bg_colour;         // CRAM index of the backdrop
+  u8 hilight_shadow;
+  u16 text_basetile;    // attributes of VDP_drawText()
+} HOST_VDP;
+
+// Counters of the VDP accesses. The words are counted by destination,
+// whether they are written by the CPU or by DMA.
+typedef struct {
+  u32 frames;
+  u32 calls;            // VDP, PAL, DMA and SPR_update calls
+  u32 cpu_words;        // written through the data port
+  u32 dma_bytes;        // DMA transfers and fills
+  u32 dma_peak;         // most DMA bytes in a frame
+  u32 tile_words;       // tile data (8 words a tile)
+  u32 map_words;        // tilemap entries
+  u32 cram_words;
+  u32 other_words;      // sprite list, scroll table
+} HOST_VDP_STATS;
+
+extern HOST_VDP host_vdp;
+extern HOST_VDP_STATS host_vdp_stats;
+
+// vdp.c
+void host_vdp_init(void);
+void host_vdp_frame_end(void);
+void host_vram_write(u16 addr, u16 value, bool dma);
+void host_vram_write_tiles(const u32 *data, u16 index, u16 num, bool dma);
+void host_cram_write(u16 index, u16 value, bool dma);
+
+// sprite.c
+void host_sprite_init(void);
+
+// screen.c
+void host_screen_compose(u8 *rgb);
+int host_screen_write(const char *filename);
+
+// sys.c
+int host_joy_script(const char *script);
+void host_joy_start(void);
+extern u32 host_frame_limit;
+
+// host.c
+extern u32 host_console_bytes;
+void host_mark(const char *label);
+void host_exit(int status);
+
+#endif
@@ -0,0 +1,11 @@
+/*
+ * Host (Linux) build of Mega mruby/c: SGDK bitmap engine.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * src/main.c includes it, but uses none of it.
+ */
+#ifndef MEGAMRBC_HOST_BMP_H_
+#define MEGAMRBC_HOST_BMP_H_
+
+#endif
@@ -0,0 +1,220 @@
+/*
+ * Host (Linux) build of Mega mruby/c: SGDK API.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * Only the part of SGDK 1.62 that src/ uses, with the same names and
+ * signatures. The functions are implemented in host/vdp.c, host/sprite.c
+ * and host/sys.c, against a model of the VDP memory, so the game runs
+ * headless and every VDP access can be counted. See host/host.h
+ */
+#ifndef MEGAMRBC_HOST_GENESIS_H_
+#define MEGAMRBC_HOST_GENESIS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+#include "tools.h"
+
+// sys.h
+typedef void VoidCallback(void);
+
+// the host runs at the NTSC timing.
+#define IS_PALSYSTEM    0
+
+extern vu32 vtimer;
+
+void SYS_doVBlankProcess(void);
+void SYS_setVIntCallback(VoidCallback *CB);
+void SYS_disableInts(void);
+void SYS_enableInts(void);
+
+// timer.h
+u32 getTick(void);
+
+// joy.h
+#define JOY_1           0x0000
+#define JOY_2           0x0001
+
+#define BUTTON_UP       0x0001
+#define BUTTON_DOWN     0x0002
+#define BUTTON_LEFT     0x0004
+#define BUTTON_RIGHT    0x0008
+#define BUTTON_A        0x0040
+#define BUTTON_B        0x0010
+#define BUTTON_C        0x0020
+#define BUTTON_START    0x0080
+#define BUTTON_X        0x0400
+#define BUTTON_Y        0x0200
+#define BUTTON_Z        0x0100
+#define BUTTON_MODE     0x0800
+
+typedef void JoyEventCallback(u16 joy, u16 changed, u16 state);
+
+void JOY_init(void);
+void JOY_setEventHandler(JoyEventCallback *CB);
+u16 JOY_readJoypad(u16 joy);
+
+// pal.h, vdp.h
+typedef struct {
+  u16 length;
+  u16 *data;
+} Palette;
+
+#define RGB24_TO_VDPCOLOR(color) \
+  ((((color) >> 20) & 0xE) | (((color) >> 8) & 0xE0) | (((color) << 4) & 0xE00))
+
+#define PAL0            0
+#define PAL1            1
+#define PAL2            2
+#define PAL3            3
+
+// VRAM of SGDK with 64x32 planes.
+#define TILE_SIZE               32
+#define TILE_SPACE              0xB000
+#define TILE_MAXNUM             (TILE_SPACE / TILE_SIZE)
+#define TILE_SYSTEMINDEX        0x0000
+#define TILE_SYSTEMLENGTH       16
+#define TILE_USERINDEX          (TILE_SYSTEMINDEX + TILE_SYSTEMLENGTH)
+#define FONT_LEN                96
+#define TILE_FONTINDEX          (TILE_MAXNUM - FONT_LEN)
+#define TILE_USERLENGTH         (TILE_FONTINDEX - TILE_USERINDEX)
+
+#define VDP_WINDOW_ADDR         0xB000
+#define VDP_BG_A_ADDR           0xC000
+#define VDP_BG_B_ADDR           0xE000
+#define VDP_HSCROLL_ADDR        0xF000
+#define VDP_SPRITE_LIST_ADDR    0xF400
+
+#define TILE_ATTR_PRIORITY_MASK 0x8000
+#define TILE_ATTR_PALETTE_MASK  0x6000
+#define TILE_ATTR_VFLIP_MASK    0x1000
+#define TILE_ATTR_HFLIP_MASK    0x0800
+#define TILE_INDEX_MASK         0x07FF
+
+#define TILE_ATTR(pal, prio, flipV, flipH) \
+  ((((u16)(prio)) << 15) | (((u16)(pal)) << 13) | \
+   (((u16)(flipV)) << 12) | (((u16)(flipH)) << 11))
+#define TILE_ATTR_FULL(pal, prio, flipV, flipH, index) \
+  (TILE_ATTR(pal, prio, flipV, flipH) | ((u16)(index)))
+
+typedef enum {
+  BG_B = 0,
+  BG_A = 1,
+  WINDOW = 2,
+} VDPPlane;
+
+typedef enum {
+  CPU = 0,
+  DMA = 1,
+  DMA_QUEUE = 2,
+  DMA_QUEUE_COPY = 3,
+} TransferMethod;
+
+#define COMPRESSION_NONE        0
+
+typedef struct {
+  u16 compression;
+  u16 numTile;
+  u32 *tiles;
+} TileSet;
+
+typedef struct {
+  u16 compression;
+  u16 w;
+  u16 h;
+  u16 *tilemap;
+} TileMap;
+
+typedef struct {
+  Palette *palette;
+  TileSet *tileset;
+  TileMap *tilemap;
+} Image;
+
+void VDP_setScreenWidth320(void);
+u16 VDP_getScreenHeight(void);
+void VDP_setHInterrupt(u8 value);
+void VDP_setHilightShadow(u8 value);
+void VDP_setBackgroundColor(u8 value);
+u16 VDP_getAdjustedVCounter(void);
+
+void VDP_setPalette(u16 numPal, const u16 *pal);
+void VDP_setPaletteColor(u16 index, u16 value);
+void PAL_setColor(u16 index, u16 value);
+void PAL_setPaletteDMA(u16 numPal, const u16 *pal);
+
+void VDP_loadTileData(const u32 *data, u16 index, u16 num, TransferMethod tm);
+bool VDP_loadTileSet(const TileSet *tileset, u16 index, TransferMethod tm);
+u16 VDP_loadFont(const TileSet *font, TransferMethod tm);
+
+void VDP_clearPlane(VDPPlane plane, bool wait);
+void VDP_setTileMapXY(VDPPlane plane, u16 tile, u16 x, u16 y);
+void VDP_fillTileMapRect(VDPPlane plane, u16 tile, u16 x, u16 y, u16 w, u16 h);
+void VDP_setTileMapDataRect(VDPPlane plane, const u16 *data, u16 x, u16 y,
+                            u16 w, u16 h, u16 wm, TransferMethod tm);
+bool VDP_setTileMapEx(VDPPlane plane, const TileMap *tilemap, u16 basetile,
+                      u16 x, u16 y, u16 xm, u16 ym, u16 w, u16 h,
+                      TransferMethod tm);
+bool VDP_drawImageEx(VDPPlane plane, const Image *image, u16 basetile,
+                     u16 x, u16 y, bool loadpal, TransferMethod tm);
+void VDP_setHorizontalScroll(VDPPlane plane, s16 value);
+
+void VDP_setTextPalette(u16 palette);
+u16 VDP_getTextPriority(void);
+void VDP_drawText(const char *str, u16 x, u16 y);
+
+// dma.h
+#define DMA_VRAM        0
+#define DMA_CRAM        1
+#define DMA_VSRAM       2
+
+bool DMA_queueDma(u8 location, void *from, u16 to, u16 len, u16 step);
+void DMA_flushQueue(void);
+
+// sprite_eng.h
+// The host keeps only the first frame of the first animation.
+typedef struct {
+  s16 w;                // in pixels
+  s16 h;
+  Palette *palette;
+  TileSet *tileset;     // tiles of the frame, in the VDP sprite order.
+} SpriteDefinition;
+
+typedef enum {
+  VISIBLE = 0,
+  HIDDEN = 1,
+} SpriteVisibility;
+
+typedef struct _Sprite {
+  const SpriteDefinition *definition;
+  s16 x;
+  s16 y;
+  u16 attribut;
+  u16 visibility;
+  struct _Sprite *next;
+} Sprite;
+
+#define SPRITE_MAX_NUM          80
+#define SPRITE_VRAM_DEFAULT     420
+
+void SPR_init(void);
+Sprite *SPR_addSprite(const SpriteDefinition *spriteDef, s16 x, s16 y, u16 attribut);
+void SPR_setPosition(Sprite *sprite, s16 x, s16 y);
+void SPR_setVisibility(Sprite *sprite, SpriteVisibility value);
+void SPR_update(void);
+
+// xgm.h, snd.h
+typedef enum {
+  SOUND_PCM_CH_AUTO = -1,
+  SOUND_PCM_CH1 = 0,
+  SOUND_PCM_CH2 = 1,
+  SOUND_PCM_CH3 = 2,
+  SOUND_PCM_CH4 = 3,
+} SoundPCMChannel;
+
+void XGM_setPCM(const u8 id, const u8 *sample, const u32 len);
+void XGM_startPlayPCM(const u8 id, const u8 priority, const SoundPCMChannel channel);
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Host (Linux) build of Mega mruby/c: SGDK tools.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * src/c_string.c includes it for KLog(), implemented in host/sys.c
+ */
+#ifndef MEGAMRBC_HOST_TOOLS_H_
+#define MEGAMRBC_HOST_TOOLS_H_
+
+void KLog(const char *text);
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * Host (Linux) build of Mega mruby/c: SGDK types.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * Same names and sizes as the types.h of SGDK 1.62, that the sources in
+ * src/ are written against.
+ */
+#ifndef MEGAMRBC_HOST_TYPES_H_
+#define MEGAMRBC_HOST_TYPES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef TRUE
+#define TRUE    1
+#endif
+#ifndef FALSE
+#define FALSE   0
+#endif
+
+typedef char s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+typedef volatile s8 vs8;
+typedef volatile s16 vs16;
+typedef volatile s32 vs32;
+typedef volatile u8 vu8;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+
+typedef u8 bool;
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Host (Linux) build of Mega mruby/c: screen.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * Composes the screen from the VDP memory, as the VDP would display it:
+ * planes A and B with the full screen horizontal scroll, the sprite list
+ * and the backdrop, by priority. The window plane, the vertical scroll and
+ * the shadow/hilight mode are not used by the game, and not drawn.
+ */
+#include <genesis.h>
+#include "host.h"
+
+// a pixel: CRAM index + 1, 0 for transparent.
+typedef struct {
+  u8 low[SCREEN_WIDTH];
+  u8 high[SCREEN_WIDTH];
+} LAYER_LINE;
+
+// colour of the pixel of a tile, 0..15.
+static u8 tile_pixel(u16 index, u16 x, u16 y) {
+  u16 word = host_vdp.vram[(index & TILE_INDEX_MASK) * 16 + y * 2 + (x >> 2)];
+  return (word >> ((3 - (x & 3)) * 4)) & 15;
+}
+
+static void draw_plane(LAYER_LINE *line, u16 addr, u16 y, s16 hscroll) {
+  u16 x;
+  for(x = 0; x < SCREEN_WIDTH; x++) {
+    u16 px = (x - hscroll) & (PLANE_WIDTH * 8 - 1);
+    u16 py = y & (PLANE_HEIGHT * 8 - 1);
+    u16 entry = host_vdp.vram[(addr >> 1) + (py >> 3) * PLANE_WIDTH + (px >> 3)];
+    u16 tx = (entry & TILE_ATTR_HFLIP_MASK) ? 7 - (px & 7) : px & 7;
+    u16 ty = (entry & TILE_ATTR_VFLIP_MASK) ? 7 - (py & 7) : py & 7;
+    u8 colour = tile_pixel(entry, tx, ty);
+    if(!colour) continue;
+
+    u8 *dest = (entry & TILE_ATTR_PRIORITY_MASK) ? line->high : line->low;
+    dest[x] = ((entry >> 13) & 3) * 16 + colour + 1;
+  }
+}
+
+// The first sprite of the list is on the top.
+static void draw_sprites(LAYER_LINE *line, u16 y) {
+  const u16 *list = &host_vdp.vram[VDP_SPRITE_LIST_ADDR >> 1];
+  u16 link = 0;
+  u16 n;
+
+  for(n = 0; n < SPRITE_MAX_NUM; n++) {
+    const u16 *sprite = &list[link * 4];
+    s16 sy = (sprite[0] & 0x3ff) - 128;
+    s16 sx = (sprite[3] & 0x1ff) - 128;
+    u16 w = ((sprite[1] >> 10) & 3) + 1;
+    u16 h = ((sprite[1] >> 8) & 3) + 1;
+    u16 attr = sprite[2];
+
+    if(y >= sy && y < sy + h * 8) {
+      u16 py = (attr & TILE_ATTR_VFLIP_MASK) ? h * 8 - 1 - (y - sy) : y - sy;
+      u8 *dest = (attr & TILE_ATTR_PRIORITY_MASK) ? line->high : line->low;
+      u16 i;
+      for(i = 0; i < w * 8; i++) {
+        s16 x = sx + i;
+        if(x < 0 || x >= SCREEN_WIDTH || line->high[x] || line->low[x]) continue;
+
+        u16 px = (attr & TILE_ATTR_HFLIP_MASK) ? w * 8 - 1 - i : i;
+        u16 tile = attr + (px >> 3) * h + (py >> 3);	// column by column
+        u8 colour = tile_pixel(tile, px & 7, py & 7);
+        if(colour) dest[x] = ((attr >> 13) & 3) * 16 + colour + 1;
+      }
+    }
+
+    link = sprite[1] & 0x7f;
+    if(link == 0) break;
+  }
+}
+
+// 0000 BBB0 GGG0 RRR0 to 8 bits a component.
+static void vdp_colour_to_rgb(u16 colour, u8 *rgb) {
+  rgb[0] = ((colour >> 1) & 7) * 255 / 7;
+  rgb[1] = ((colour >> 5) & 7) * 255 / 7;
+  rgb[2] = ((colour >> 9) & 7) * 255 / 7;
+}
+
+// Composes the screen, 3 bytes (RGB) a pixel.
+void host_screen_compose(u8 *rgb) {
+  s16 hscroll_a = host_vdp.vram[VDP_HSCROLL_ADDR >> 1];
+  s16 hscroll_b = host_vdp.vram[(VDP_HSCROLL_ADDR >> 1) + 1];
+  u16 y, x;
+
+  for(y = 0; y < SCREEN_HEIGHT; y++) {
+    LAYER_LINE sprite, plane_a, plane_b;
+    memset(&sprite, 0, sizeof(sprite));
+    memset(&plane_a, 0, sizeof(plane_a));
+    memset(&plane_b, 0, sizeof(plane_b));
+    draw_sprites(&sprite, y);
+    draw_plane(&plane_a, VDP_BG_A_ADDR, y, hscroll_a);
+    draw_plane(&plane_b, VDP_BG_B_ADDR, y, hscroll_b);
+
+    for(x = 0; x < SCREEN_WIDTH; x++) {
+      const u8 order[] = { sprite.high[x], plane_a.high[x], plane_b.high[x],
+                           sprite.low[x], plane_a.low[x], plane_b.low[x] };
+      u8 index = host_vdp.bg_colour;
+      u16 i;
+      for(i = 0; i < sizeof(order); i++) {
+        if(order[i]) {
+          index = order[i] - 1;
+          break;
+        }
+      }
+      vdp_colour_to_rgb(host_vdp.cram[index], rgb);
+      rgb += 3;
+    }
+  }
+}
+
+// Writes the screen to a binary PPM file. Returns 0 if no error.
+int host_screen_write(const char *filename) {
+  static u8 rgb[SCREEN_WIDTH * SCREEN_HEIGHT * 3];
+  FILE *fp = fopen(filename, "wb");
+  if(!fp) return -1;
+
+  host_screen_compose(rgb);
+  fprintf(fp, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+  size_t n = fwrite(rgb, 1, sizeof(rgb), fp);
+  return (fclose(fp) == 0 && n == sizeof(rgb)) ? 0 : -1;
+}
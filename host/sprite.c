@@ -0,0 +1,101 @@
+/*
+ * Host (Linux) build of Mega mruby/c: sprite engine.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * The tiles of a sprite are loaded in the sprite area at the end of the
+ * user tiles when it is added, as SPR_init() reserves it on the device.
+ * SPR_update() writes the sprite list by DMA. A frame bigger than 4x4
+ * tiles is made of several VDP sprites, in the order of its tileset.
+ */
+#include <genesis.h>
+#include "host.h"
+
+#define SPRITE_TILE_BASE (TILE_USERINDEX + TILE_USERLENGTH - SPRITE_VRAM_DEFAULT)
+
+static Sprite sprites[SPRITE_MAX_NUM];
+static u16 sprite_tiles[SPRITE_MAX_NUM];	// VRAM tile index of the sprite
+static u16 sprite_count;
+static u16 next_tile;
+
+void host_sprite_init(void) {
+  memset(sprites, 0, sizeof(sprites));
+  sprite_count = 0;
+  next_tile = SPRITE_TILE_BASE;
+}
+
+void SPR_init(void) {
+  host_sprite_init();
+}
+
+Sprite *SPR_addSprite(const SpriteDefinition *spriteDef, s16 x, s16 y, u16 attribut) {
+  const TileSet *tileset = spriteDef->tileset;
+
+  if(sprite_count >= SPRITE_MAX_NUM) return NULL;
+  if(next_tile + tileset->numTile > SPRITE_TILE_BASE + SPRITE_VRAM_DEFAULT) return NULL;
+
+  Sprite *sprite = &sprites[sprite_count];
+  sprite->definition = spriteDef;
+  sprite->x = x;
+  sprite->y = y;
+  sprite->attribut = attribut;
+  sprite->visibility = VISIBLE;
+  sprite->next = NULL;
+  if(sprite_count > 0) sprites[sprite_count - 1].next = sprite;
+
+  sprite_tiles[sprite_count++] = next_tile;
+  VDP_loadTileData(tileset->tiles, next_tile, tileset->numTile, DMA_QUEUE);
+  next_tile += tileset->numTile;
+
+  return sprite;
+}
+
+void SPR_setPosition(Sprite *sprite, s16 x, s16 y) {
+  sprite->x = x;
+  sprite->y = y;
+}
+
+void SPR_setVisibility(Sprite *sprite, SpriteVisibility value) {
+  sprite->visibility = value;
+}
+
+// Builds the sprite list of the visible sprites, and queues its DMA.
+void SPR_update(void) {
+  static u16 list[SPRITE_MAX_NUM * 4];
+  u16 n = 0;
+  u16 i;
+
+  host_vdp_stats.calls++;
+  for(i = 0; i < sprite_count; i++) {
+    const Sprite *sprite = &sprites[i];
+    if(sprite->visibility != VISIBLE) continue;
+
+    const SpriteDefinition *def = sprite->definition;
+    u16 tw = (def->w + 7) / 8;
+    u16 th = (def->h + 7) / 8;
+    u16 tile = sprite_tiles[i];
+    u16 cy, cx;
+    for(cy = 0; cy < th; cy += 4) {
+      u16 h = (th - cy > 4) ? 4 : th - cy;
+      for(cx = 0; cx < tw; cx += 4) {
+        u16 w = (tw - cx > 4) ? 4 : tw - cx;
+        if(n >= SPRITE_MAX_NUM) break;
+        list[n * 4 + 0] = (sprite->y + cy * 8 + 128) & 0x3ff;
+        list[n * 4 + 1] = ((w - 1) << 10) | ((h - 1) << 8) | (n + 1);
+        list[n * 4 + 2] = (sprite->attribut & ~TILE_INDEX_MASK) | tile;
+        list[n * 4 + 3] = (sprite->x + cx * 8 + 128) & 0x1ff;
+        tile += w * h;
+        n++;
+      }
+    }
+  }
+
+  if(n == 0) {
+    // an empty list is a sprite out of the screen.
+    memset(list, 0, 8);
+    n = 1;
+  }
+  list[(n - 1) * 4 + 1] &= 0xff00;	// end of the links.
+
+  DMA_queueDma(DMA_VRAM, list, VDP_SPRITE_LIST_ADDR, n * 4, 2);
+}
@@ -0,0 +1,210 @@
+/*
+ * Host (Linux) build of Mega mruby/c: system, joypad and sound.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * A frame passes in SYS_doVBlankProcess(), as fast as the host runs. The
+ * joypad is played from a script, one step a frame:
+ *
+ *   60             no button for 60 frames
+ *   A  START  B+C  press the button(s) for a frame
+ *   @label         begin a section of the report, labelled label
+ *   quit           end the run (also at the end of the script)
+ *   # comment      to the end of the line
+ */
+#include <ctype.h>
+#include <genesis.h>
+#include "host.h"
+
+#define TICKS_PER_FRAME 5	// getTick() is 1/300s
+
+vu32 vtimer;
+u32 host_frame_limit;
+
+static VoidCallback *vint_callback;
+static JoyEventCallback *joy_callback;
+static u16 joy_state;
+
+enum { STEP_WAIT, STEP_PRESS, STEP_MARK, STEP_QUIT };
+
+static struct JOY_STEP {
+  u8 type;
+  u16 arg;		// frames, or buttons
+  char *label;
+} *joy_steps;
+static u32 joy_step_count;
+static u32 joy_pc;
+static u16 joy_wait;
+
+static const struct {
+  const char *name;
+  u16 button;
+} button_names[] = {
+  { "UP", BUTTON_UP }, { "DOWN", BUTTON_DOWN },
+  { "LEFT", BUTTON_LEFT }, { "RIGHT", BUTTON_RIGHT },
+  { "A", BUTTON_A }, { "B", BUTTON_B }, { "C", BUTTON_C },
+  { "X", BUTTON_X }, { "Y", BUTTON_Y }, { "Z", BUTTON_Z },
+  { "START", BUTTON_START }, { "MODE", BUTTON_MODE },
+};
+#define BUTTON_NAMES_SIZE (sizeof(button_names) / sizeof(button_names[0]))
+
+static u16 parse_buttons(char *word) {
+  u16 buttons = 0;
+  char *name = strtok(word, "+");
+  while(name) {
+    u16 i;
+    for(i = 0; i < BUTTON_NAMES_SIZE; i++) {
+      if(strcmp(name, button_names[i].name) == 0) break;
+    }
+    if(i == BUTTON_NAMES_SIZE) return 0;
+    buttons |= button_names[i].button;
+    name = strtok(NULL, "+");
+  }
+  return buttons;
+}
+
+// Parses the joypad script. Returns 0, or the line of the error.
+int host_joy_script(const char *script) {
+  u32 capacity = 16;
+  int line = 1;
+  const char *p = script;
+
+  joy_steps = malloc(capacity * sizeof(*joy_steps));
+  joy_step_count = 0;
+
+  while(*p) {
+    if(*p == '#') {
+      while(*p && *p != '\n') p++;
+      continue;
+    }
+    if(isspace((u8)*p)) {
+      if(*p++ == '\n') line++;
+      continue;
+    }
+
+    const char *start = p;
+    while(*p && !isspace((u8)*p) && *p != '#') p++;
+    char word[64];
+    size_t len = p - start;
+    if(len >= sizeof(word)) return line;
+    memcpy(word, start, len);
+    word[len] = '\0';
+
+    if(joy_step_count == capacity) {
+      capacity *= 2;
+      joy_steps = realloc(joy_steps, capacity * sizeof(*joy_steps));
+    }
+    struct JOY_STEP *step = &joy_steps[joy_step_count++];
+    step->label = NULL;
+
+    if(isdigit((u8)word[0])) {
+      char *end;
+      unsigned long frames = strtoul(word, &end, 10);
+      if(*end || frames == 0 || frames > 0xffff) return line;
+      step->type = STEP_WAIT;
+      step->arg = frames;
+    } else if(word[0] == '@') {
+      step->type = STEP_MARK;
+      step->label = strdup(word + 1);
+    } else if(strcmp(word, "quit") == 0) {
+      step->type = STEP_QUIT;
+    } else {
+      step->type = STEP_PRESS;
+      step->arg = parse_buttons(word);
+      if(!step->arg) return line;
+    }
+  }
+  return 0;
+}
+
+static void joy_set(u16 state) {
+  u16 changed = joy_state ^ state;
+  joy_state = state;
+  if(changed && joy_callback) joy_callback(JOY_1, changed, state);
+}
+
+// Plays the marks at the beginning of the script, before the first frame,
+// so that the script can name the first section.
+void host_joy_start(void) {
+  while(joy_pc < joy_step_count && joy_steps[joy_pc].type == STEP_MARK) {
+    host_mark(joy_steps[joy_pc++].label);
+  }
+}
+
+// Plays the script for a frame.
+static void joy_update(void) {
+  joy_set(0);
+  if(!joy_steps) return;
+  if(joy_wait > 0) {
+    joy_wait--;
+    return;
+  }
+
+  while(joy_pc < joy_step_count) {
+    const struct JOY_STEP *step = &joy_steps[joy_pc++];
+    switch(step->type) {
+    case STEP_WAIT:
+      joy_wait = step->arg - 1;
+      return;
+    case STEP_PRESS:
+      joy_set(step->arg);
+      return;
+    case STEP_MARK:
+      host_mark(step->label);
+      break;
+    case STEP_QUIT:
+      host_exit(0);
+    }
+  }
+  host_exit(0);
+}
+
+// The vblank: the queued DMA, then the vertical interrupt.
+void SYS_doVBlankProcess(void) {
+  DMA_flushQueue();
+  host_vdp_frame_end();
+
+  vtimer++;
+  if(vint_callback) vint_callback();
+  joy_update();
+
+  if(host_frame_limit && vtimer >= host_frame_limit) host_exit(0);
+}
+
+void SYS_setVIntCallback(VoidCallback *CB) {
+  vint_callback = CB;
+}
+
+// the vertical interrupt is only called from SYS_doVBlankProcess().
+void SYS_disableInts(void) {
+}
+
+void SYS_enableInts(void) {
+}
+
+u32 getTick(void) {
+  return vtimer * TICKS_PER_FRAME;
+}
+
+void KLog(const char *text) {
+  fprintf(stderr, "%s\n", text);
+}
+
+void JOY_init(void) {
+  joy_state = 0;
+}
+
+void JOY_setEventHandler(JoyEventCallback *CB) {
+  joy_callback = CB;
+}
+
+u16 JOY_readJoypad(u16 joy) {
+  return (joy == JOY_1) ? joy_state : 0;
+}
+
+// no sound on the host.
+void XGM_setPCM(const u8 id, const u8 *sample, const u32 len) {
+}
+
+void XGM_startPlayPCM(const u8 id, const u8 priority, const SoundPCMChannel channel) {
+}
@@ -0,0 +1,346 @@
+/*
+ * Host (Linux) build of Mega mruby/c: VDP and DMA.
+ *
+ *  This file is distributed under BSD 3-Clause License.
+ *
+ * The VRAM and CRAM are written the way SGDK writes them, by the CPU or by
+ * DMA, and the accesses are counted in host_vdp_stats. Queued DMA is done
+ * by DMA_flushQueue() or in the vblank, as on the device. The timing is
+ * not emulated: the VDP is always in the vblank, when the CPU asks.
+ */
+#include <genesis.h>
+#include "host.h"
+
+#define DMA_QUEUE_SIZE  80
+
+HOST_VDP host_vdp;
+HOST_VDP_STATS host_vdp_stats;
+
+static u32 frame_dma_bytes;
+
+static struct DMA_JOB {
+  u8 location;
+  const void *from;
+  u16 to;
+  u16 len;      // in words
+  u16 step;
+} dma_queue[DMA_QUEUE_SIZE];
+static u16 dma_queue_count;
+
+
+static u16 plane_addr(VDPPlane plane) {
+  switch(plane) {
+  case BG_A: return VDP_BG_A_ADDR;
+  case BG_B: return VDP_BG_B_ADDR;
+  default: return VDP_WINDOW_ADDR;
+  }
+}
+
+static void count_dma(u32 bytes) {
+  host_vdp_stats.dma_bytes += bytes;
+  frame_dma_bytes += bytes;
+}
+
+void host_vdp_init(void) {
+  memset(&host_vdp, 0, sizeof(host_vdp));
+  host_vdp.text_basetile = TILE_ATTR_FULL(PAL0, TRUE, FALSE, FALSE, TILE_FONTINDEX);
+  dma_queue_count = 0;
+  frame_dma_bytes = 0;
+}
+
+// Called in the vblank, after the queued DMA is done.
+void host_vdp_frame_end(void) {
+  if(frame_dma_bytes > host_vdp_stats.dma_peak) host_vdp_stats.dma_peak = frame_dma_bytes;
+  frame_dma_bytes = 0;
+  host_vdp_stats.frames++;
+}
+
+void host_vram_write(u16 addr, u16 value, bool dma) {
+  host_vdp.vram[(addr >> 1) & 0x7fff] = value;
+
+  if(dma) count_dma(2);
+  else host_vdp_stats.cpu_words++;
+
+  if(addr < TILE_SPACE) host_vdp_stats.tile_words++;
+  else if(addr < VDP_HSCROLL_ADDR) host_vdp_stats.map_words++;
+  else host_vdp_stats.other_words++;
+}
+
+// A tile is 8 u32 of 8 pixels, the leftmost pixel in the high nibble.
+void host_vram_write_tiles(const u32 *data, u16 index, u16 num, bool dma) {
+  u16 addr = index * TILE_SIZE;
+  u32 i;
+  for(i = 0; i < (u32)num * 8; i++) {
+    host_vram_write(addr, data[i] >> 16, dma);
+    host_vram_write(addr + 2, data[i] & 0xffff, dma);
+    addr += 4;
+  }
+}
+
+void host_cram_write(u16 index, u16 value, bool dma) {
+  host_vdp.cram[index & 63] = value & 0x0eee;
+
+  if(dma) count_dma(2);
+  else host_vdp_stats.cpu_words++;
+  host_vdp_stats.cram_words++;
+}
+
+// DMA of words from the 68000 memory. The tile data of SGDK is u32, and
+// the rest u16: on the host, the order of the words in a u32 is that of
+// the host, so the tile area is read by u32.
+static void dma_do(const struct DMA_JOB *job) {
+  u16 i;
+
+  if(job->location == DMA_CRAM) {
+    const u16 *src = job->from;
+    for(i = 0; i < job->len; i++) host_cram_write((job->to >> 1) + i * (job->step >> 1), src[i], TRUE);
+    return;
+  }
+  if(job->location != DMA_VRAM) {
+    count_dma(job->len * 2);
+    return;
+  }
+
+  if(job->to < TILE_SPACE && job->step == 2 && !(job->to & 3) && !(job->len & 1)) {
+    const u32 *src = job->from;
+    for(i = 0; i < job->len / 2; i++) {
+      host_vram_write(job->to + i * 4, src[i] >> 16, TRUE);
+      host_vram_write(job->to + i * 4 + 2, src[i] & 0xffff, TRUE);
+    }
+    return;
+  }
+
+  const u16 *src = job->from;
+  for(i = 0; i < job->len; i++) host_vram_write(job->to + i * job->step, src[i], TRUE);
+}
+
+bool DMA_queueDma(u8 location, void *from, u16 to, u16 len, u16 step) {
+  host_vdp_stats.calls++;
+  if(dma_queue_count >= DMA_QUEUE_SIZE) return FALSE;
+
+  struct DMA_JOB *job = &dma_queue[dma_queue_count++];
+  job->location = location;
+  job->from = from;
+  job->to = to;
+  job->len = len;
+  job->step = step;
+  return TRUE;
+}
+
+void DMA_flushQueue(void) {
+  u16 i;
+  for(i = 0; i < dma_queue_count; i++) dma_do(&dma_queue[i]);
+  dma_queue_count = 0;
+}
+
+// DMA, either queued or done now, or CPU writes.
+static void transfer(u8 location, const void *from, u16 to, u16 len, TransferMethod tm) {
+  if(tm == DMA_QUEUE || tm == DMA_QUEUE_COPY) {
+    if(dma_queue_count < DMA_QUEUE_SIZE) {
+      struct DMA_JOB *job = &dma_queue[dma_queue_count++];
+      job->location = location;
+      job->from = from;
+      job->to = to;
+      job->len = len;
+      job->step = 2;
+      return;
+    }
+    tm = DMA;
+  }
+
+  struct DMA_JOB job = { location, from, to, len, 2 };
+  if(tm == DMA) {
+    dma_do(&job);
+    return;
+  }
+
+  const u16 *src = from;
+  u16 i;
+  for(i = 0; i < len; i++) {
+    if(location == DMA_CRAM) host_cram_write((to >> 1) + i, src[i], FALSE);
+    else host_vram_write(to + i * 2, src[i], FALSE);
+  }
+}
+
+// Screen and registers.
+
+void VDP_setScreenWidth320(void) {
+  host_vdp_stats.calls++;
+}
+
+u16 VDP_getScreenHeight(void) {
+  return SCREEN_HEIGHT;
+}
+
+void VDP_setHInterrupt(u8 value) {
+  host_vdp_stats.calls++;
+}
+
+void VDP_setHilightShadow(u8 value) {
+  host_vdp_stats.calls++;
+  host_vdp.hilight_shadow = value;
+}
+
+void VDP_setBackgroundColor(u8 value) {
+  host_vdp_stats.calls++;
+  host_vdp.bg_colour = value & 63;
+}
+
+// the first line of the vblank: the frame has taken no time.
+u16 VDP_getAdjustedVCounter(void) {
+  return SCREEN_HEIGHT;
+}
+
+// Palettes.
+
+void VDP_setPalette(u16 numPal, const u16 *pal) {
+  host_vdp_stats.calls++;
+  transfer(DMA_CRAM, pal, numPal * 32, 16, CPU);
+}
+
+void VDP_setPaletteColor(u16 index, u16 value) {
+  host_vdp_stats.calls++;
+  host_cram_write(index, value, FALSE);
+}
+
+void PAL_setColor(u16 index, u16 value) {
+  VDP_setPaletteColor(index, value);
+}
+
+void PAL_setPaletteDMA(u16 numPal, const u16 *pal) {
+  host_vdp_stats.calls++;
+  transfer(DMA_CRAM, pal, numPal * 32, 16, DMA);
+}
+
+// Tiles.
+
+void VDP_loadTileData(const u32 *data, u16 index, u16 num, TransferMethod tm) {
+  host_vdp_stats.calls++;
+  if(tm == CPU) {
+    host_vram_write_tiles(data, index, num, FALSE);
+  } else {
+    transfer(DMA_VRAM, data, index * TILE_SIZE, num * 16, tm);
+  }
+}
+
+// the host resources are not compressed.
+bool VDP_loadTileSet(const TileSet *tileset, u16 index, TransferMethod tm) {
+  if(tileset->compression != COMPRESSION_NONE) return FALSE;
+  VDP_loadTileData(tileset->tiles, index, tileset->numTile, tm);
+  return TRUE;
+}
+
+u16 VDP_loadFont(const TileSet *font, TransferMethod tm) {
+  return VDP_loadTileSet(font, TILE_FONTINDEX, tm);
+}
+
+// Tilemaps.
+
+void VDP_clearPlane(VDPPlane plane, bool wait) {
+  u16 addr = plane_addr(plane);
+  u16 i;
+
+  host_vdp_stats.calls++;
+  for(i = 0; i < PLANE_WIDTH * PLANE_HEIGHT; i++) {
+    host_vdp.vram[(addr >> 1) + i] = 0;
+  }
+  // a DMA fill.
+  count_dma(PLANE_WIDTH * PLANE_HEIGHT * 2);
+  host_vdp_stats.map_words += PLANE_WIDTH * PLANE_HEIGHT;
+}
+
+static u16 cell_addr(VDPPlane plane, u16 x, u16 y) {
+  return plane_addr(plane) + (((y & (PLANE_HEIGHT - 1)) * PLANE_WIDTH + (x & (PLANE_WIDTH - 1))) << 1);
+}
+
+void VDP_setTileMapXY(VDPPlane plane, u16 tile, u16 x, u16 y) {
+  host_vdp_stats.calls++;
+  host_vram_write(cell_addr(plane, x, y), tile, FALSE);
+}
+
+void VDP_fillTileMapRect(VDPPlane plane, u16 tile, u16 x, u16 y, u16 w, u16 h) {
+  u16 i, j;
+
+  host_vdp_stats.calls++;
+  for(j = 0; j < h; j++) {
+    for(i = 0; i < w; i++) host_vram_write(cell_addr(plane, x + i, y + j), tile, FALSE);
+  }
+}
+
+// A row is a DMA, unless the tm is CPU. With an offset, SGDK prepares the
+// row in RAM first.
+static void tilemap_row(VDPPlane plane, const u16 *data, u16 add, u16 x, u16 y, u16 w, TransferMethod tm) {
+  u16 i;
+
+  if(tm != CPU && add == 0 && x + w <= PLANE_WIDTH) {
+    transfer(DMA_VRAM, data, cell_addr(plane, x, y), w, tm);
+    return;
+  }
+  for(i = 0; i < w; i++) {
+    host_vram_write(cell_addr(plane, x + i, y), data[i] + add, tm != CPU);
+  }
+}
+
+void VDP_setTileMapDataRect(VDPPlane plane, const u16 *data, u16 x, u16 y,
+                            u16 w, u16 h, u16 wm, TransferMethod tm) {
+  u16 j;
+
+  host_vdp_stats.calls++;
+  for(j = 0; j < h; j++) tilemap_row(plane, data + j * wm, 0, x, y + j, w, tm);
+}
+
+// the entries of the tilemap are offset by basetile.
+bool VDP_setTileMapEx(VDPPlane plane, const TileMap *tilemap, u16 basetile,
+                      u16 x, u16 y, u16 xm, u16 ym, u16 w, u16 h,
+                      TransferMethod tm) {
+  u16 j;
+
+  host_vdp_stats.calls++;
+  if(tilemap->compression != COMPRESSION_NONE) return FALSE;
+  for(j = 0; j < h; j++) {
+    tilemap_row(plane, tilemap->tilemap + (ym + j) * tilemap->w + xm, basetile,
+                x, y + j, w, tm);
+  }
+  return TRUE;
+}
+
+bool VDP_drawImageEx(VDPPlane plane, const Image *image, u16 basetile,
+                     u16 x, u16 y, bool loadpal, TransferMethod tm) {
+  if(loadpal) {
+    u16 pal = (basetile & TILE_ATTR_PALETTE_MASK) >> 13;
+    u16 len = image->palette->length;
+    if(len > (4 - pal) * 16) len = (4 - pal) * 16;
+    host_vdp_stats.calls++;
+    transfer(DMA_CRAM, image->palette->data, pal * 32, len, tm);
+  }
+  if(!VDP_loadTileSet(image->tileset, basetile & TILE_INDEX_MASK, tm)) return FALSE;
+  return VDP_setTileMapEx(plane, image->tilemap, basetile, x, y, 0, 0,
+                          image->tilemap->w, image->tilemap->h, tm);
+}
+
+void VDP_setHorizontalScroll(VDPPlane plane, s16 value) {
+  host_vdp_stats.calls++;
+  host_vram_write(VDP_HSCROLL_ADDR + ((plane == BG_B) ? 2 : 0), value, FALSE);
+}
+
+// Text.
+
+void VDP_setTextPalette(u16 palette) {
+  host_vdp.text_basetile = (host_vdp.text_basetile & ~TILE_ATTR_PALETTE_MASK) |
+    TILE_ATTR(palette & 3, FALSE, FALSE, FALSE);
+}
+
+u16 VDP_getTextPriority(void) {
+  return (host_vdp.text_basetile & TILE_ATTR_PRIORITY_MASK) ? 1 : 0;
+}
+
+void VDP_drawText(const char *str, u16 x, u16 y) {
+  u16 i;
+
+  host_vdp_stats.calls++;
+  for(i = 0; str[i] && x + i < PLANE_WIDTH; i++) {
+    u8 c = str[i];
+    u16 tile = (c < 32 || c >= 32 + FONT_LEN) ? 0 : c - 32;
+    host_vram_write(cell_addr(BG_A, x + i, y), host_vdp.text_basetile + tile, FALSE);
+  }
+}
@@ -1,4 +1,5 @@
 BIN     content   "bin/example.txt" NONE
+BIN     slides    "bin/example.slides" NONE
 IMAGE   sky_bg    "backgrounds/sky-background.png" NONE ALL
 IMAGE   mountains_bg "backgrounds/mountains-background.png" NONE ALL
 IMAGE   main_logo "backgrounds/main_logo.png" NONE ALL
@@ -25,155 +25,159 @@ static const char *builtin_symbols[] = {
   "E",			// MRBC_SYMID_E = 18
   "Exception",		// MRBC_SYMID_Exception = 19
   "FalseClass",		// MRBC_SYMID_FalseClass = 20
-  "Float",		// MRBC_SYMID_Float = 21
-  "Hash",		// MRBC_SYMID_Hash = 22
-  "IndexError",		// MRBC_SYMID_IndexError = 23
-  "Integer",		// MRBC_SYMID_Integer = 24
-  "MRUBYC_VERSION",	// MRBC_SYMID_MRUBYC_VERSION = 25
-  "MRUBY_VERSION",	// MRBC_SYMID_MRUBY_VERSION = 26
-  "Math",		// MRBC_SYMID_Math = 27
-  "NameError",		// MRBC_SYMID_NameError = 28
-  "NilClass",		// MRBC_SYMID_NilClass = 29
-  "NoMemoryError",	// MRBC_SYMID_NoMemoryError = 30
-  "NoMethodError",	// MRBC_SYMID_NoMethodError = 31
-  "NotImplementedError",	// MRBC_SYMID_NotImplementedError = 32
-  "Object",		// MRBC_SYMID_Object = 33
-  "PI",			// MRBC_SYMID_PI = 34
-  "Proc",		// MRBC_SYMID_Proc = 35
-  "RUBY_ENGINE",	// MRBC_SYMID_RUBY_ENGINE = 36
-  "RUBY_VERSION",	// MRBC_SYMID_RUBY_VERSION = 37
-  "Range",		// MRBC_SYMID_Range = 38
-  "RangeError",		// MRBC_SYMID_RangeError = 39
-  "RuntimeError",	// MRBC_SYMID_RuntimeError = 40
-  "StandardError",	// MRBC_SYMID_StandardError = 41
-  "String",		// MRBC_SYMID_String = 42
-  "Symbol",		// MRBC_SYMID_Symbol = 43
-  "TrueClass",		// MRBC_SYMID_TrueClass = 44
-  "TypeError",		// MRBC_SYMID_TypeError = 45
-  "ZeroDivisionError",	// MRBC_SYMID_ZeroDivisionError = 46
-  "[]",			// MRBC_SYMID_BL_BR = 47
-  "[]=",		// MRBC_SYMID_BL_BR_EQ = 48
-  "^",			// MRBC_SYMID_XOR = 49
-  "abs",		// MRBC_SYMID_abs = 50
-  "acos",		// MRBC_SYMID_acos = 51
-  "acosh",		// MRBC_SYMID_acosh = 52
-  "all_symbols",	// MRBC_SYMID_all_symbols = 53
-  "asin",		// MRBC_SYMID_asin = 54
-  "asinh",		// MRBC_SYMID_asinh = 55
-  "at",			// MRBC_SYMID_at = 56
-  "atan",		// MRBC_SYMID_atan = 57
-  "atan2",		// MRBC_SYMID_atan2 = 58
-  "atanh",		// MRBC_SYMID_atanh = 59
-  "attr_accessor",	// MRBC_SYMID_attr_accessor = 60
-  "attr_reader",	// MRBC_SYMID_attr_reader = 61
-  "b",			// MRBC_SYMID_b = 62
-  "block_given?",	// MRBC_SYMID_block_given_Q = 63
-  "call",		// MRBC_SYMID_call = 64
-  "cbrt",		// MRBC_SYMID_cbrt = 65
-  "chomp",		// MRBC_SYMID_chomp = 66
-  "chomp!",		// MRBC_SYMID_chomp_E = 67
-  "chr",		// MRBC_SYMID_chr = 68
-  "class",		// MRBC_SYMID_class = 69
-  "clear",		// MRBC_SYMID_clear = 70
-  "collect",		// MRBC_SYMID_collect = 71
-  "collect!",		// MRBC_SYMID_collect_E = 72
-  "cos",		// MRBC_SYMID_cos = 73
-  "cosh",		// MRBC_SYMID_cosh = 74
-  "count",		// MRBC_SYMID_count = 75
-  "delete",		// MRBC_SYMID_delete = 76
-  "delete_at",		// MRBC_SYMID_delete_at = 77
-  "delete_if",		// MRBC_SYMID_delete_if = 78
-  "dup",		// MRBC_SYMID_dup = 79
-  "each",		// MRBC_SYMID_each = 80
-  "each_byte",		// MRBC_SYMID_each_byte = 81
-  "each_char",		// MRBC_SYMID_each_char = 82
-  "each_index",		// MRBC_SYMID_each_index = 83
-  "each_with_index",	// MRBC_SYMID_each_with_index = 84
-  "empty?",		// MRBC_SYMID_empty_Q = 85
-  "end_with?",		// MRBC_SYMID_end_with_Q = 86
-  "erf",		// MRBC_SYMID_erf = 87
-  "erfc",		// MRBC_SYMID_erfc = 88
-  "exclude_end?",	// MRBC_SYMID_exclude_end_Q = 89
-  "exp",		// MRBC_SYMID_exp = 90
-  "first",		// MRBC_SYMID_first = 91
-  "getbyte",		// MRBC_SYMID_getbyte = 92
-  "has_key?",		// MRBC_SYMID_has_key_Q = 93
-  "has_value?",		// MRBC_SYMID_has_value_Q = 94
-  "hypot",		// MRBC_SYMID_hypot = 95
-  "id2name",		// MRBC_SYMID_id2name = 96
-  "include?",		// MRBC_SYMID_include_Q = 97
-  "index",		// MRBC_SYMID_index = 98
-  "initialize",		// MRBC_SYMID_initialize = 99
-  "inspect",		// MRBC_SYMID_inspect = 100
-  "instance_methods",	// MRBC_SYMID_instance_methods = 101
-  "instance_variables",	// MRBC_SYMID_instance_variables = 102
-  "intern",		// MRBC_SYMID_intern = 103
-  "is_a?",		// MRBC_SYMID_is_a_Q = 104
-  "join",		// MRBC_SYMID_join = 105
-  "key",		// MRBC_SYMID_key = 106
-  "keys",		// MRBC_SYMID_keys = 107
-  "kind_of?",		// MRBC_SYMID_kind_of_Q = 108
-  "last",		// MRBC_SYMID_last = 109
-  "ldexp",		// MRBC_SYMID_ldexp = 110
-  "length",		// MRBC_SYMID_length = 111
-  "log",		// MRBC_SYMID_log = 112
-  "log10",		// MRBC_SYMID_log10 = 113
-  "log2",		// MRBC_SYMID_log2 = 114
-  "loop",		// MRBC_SYMID_loop = 115
-  "lstrip",		// MRBC_SYMID_lstrip = 116
-  "lstrip!",		// MRBC_SYMID_lstrip_E = 117
-  "map",		// MRBC_SYMID_map = 118
-  "map!",		// MRBC_SYMID_map_E = 119
-  "max",		// MRBC_SYMID_max = 120
-  "memory_statistics",	// MRBC_SYMID_memory_statistics = 121
-  "merge",		// MRBC_SYMID_merge = 122
-  "merge!",		// MRBC_SYMID_merge_E = 123
-  "message",		// MRBC_SYMID_message = 124
-  "min",		// MRBC_SYMID_min = 125
-  "minmax",		// MRBC_SYMID_minmax = 126
-  "new",		// MRBC_SYMID_new = 127
-  "nil?",		// MRBC_SYMID_nil_Q = 128
-  "object_id",		// MRBC_SYMID_object_id = 129
-  "ord",		// MRBC_SYMID_ord = 130
-  "p",			// MRBC_SYMID_p = 131
-  "pop",		// MRBC_SYMID_pop = 132
-  "print",		// MRBC_SYMID_print = 133
-  "printf",		// MRBC_SYMID_printf = 134
-  "push",		// MRBC_SYMID_push = 135
-  "puts",		// MRBC_SYMID_puts = 136
-  "raise",		// MRBC_SYMID_raise = 137
-  "reject",		// MRBC_SYMID_reject = 138
-  "reject!",		// MRBC_SYMID_reject_E = 139
-  "rstrip",		// MRBC_SYMID_rstrip = 140
-  "rstrip!",		// MRBC_SYMID_rstrip_E = 141
-  "shift",		// MRBC_SYMID_shift = 142
-  "sin",		// MRBC_SYMID_sin = 143
-  "sinh",		// MRBC_SYMID_sinh = 144
-  "size",		// MRBC_SYMID_size = 145
-  "slice!",		// MRBC_SYMID_slice_E = 146
-  "sort",		// MRBC_SYMID_sort = 147
-  "sort!",		// MRBC_SYMID_sort_E = 148
-  "split",		// MRBC_SYMID_split = 149
-  "sprintf",		// MRBC_SYMID_sprintf = 150
-  "sqrt",		// MRBC_SYMID_sqrt = 151
-  "start_with?",	// MRBC_SYMID_start_with_Q = 152
-  "strip",		// MRBC_SYMID_strip = 153
-  "strip!",		// MRBC_SYMID_strip_E = 154
-  "tan",		// MRBC_SYMID_tan = 155
-  "tanh",		// MRBC_SYMID_tanh = 156
-  "times",		// MRBC_SYMID_times = 157
-  "to_a",		// MRBC_SYMID_to_a = 158
-  "to_f",		// MRBC_SYMID_to_f = 159
-  "to_h",		// MRBC_SYMID_to_h = 160
-  "to_i",		// MRBC_SYMID_to_i = 161
-  "to_s",		// MRBC_SYMID_to_s = 162
-  "to_sym",		// MRBC_SYMID_to_sym = 163
-  "tr",			// MRBC_SYMID_tr = 164
-  "tr!",		// MRBC_SYMID_tr_E = 165
-  "unshift",		// MRBC_SYMID_unshift = 166
-  "values",		// MRBC_SYMID_values = 167
-  "|",			// MRBC_SYMID_OR = 168
-  "~",			// MRBC_SYMID_NEG = 169
+  "Fiber",		// MRBC_SYMID_Fiber = 21
+  "Float",		// MRBC_SYMID_Float = 22
+  "Hash",		// MRBC_SYMID_Hash = 23
+  "IndexError",		// MRBC_SYMID_IndexError = 24
+  "Integer",		// MRBC_SYMID_Integer = 25
+  "MRUBYC_VERSION",	// MRBC_SYMID_MRUBYC_VERSION = 26
+  "MRUBY_VERSION",	// MRBC_SYMID_MRUBY_VERSION = 27
+  "Math",		// MRBC_SYMID_Math = 28
+  "NameError",		// MRBC_SYMID_NameError = 29
+  "NilClass",		// MRBC_SYMID_NilClass = 30
+  "NoMemoryError",	// MRBC_SYMID_NoMemoryError = 31
+  "NoMethodError",	// MRBC_SYMID_NoMethodError = 32
+  "NotImplementedError",	// MRBC_SYMID_NotImplementedError = 33
+  "Object",		// MRBC_SYMID_Object = 34
+  "PI",			// MRBC_SYMID_PI = 35
+  "Proc",		// MRBC_SYMID_Proc = 36
+  "RUBY_ENGINE",	// MRBC_SYMID_RUBY_ENGINE = 37
+  "RUBY_VERSION",	// MRBC_SYMID_RUBY_VERSION = 38
+  "Range",		// MRBC_SYMID_Range = 39
+  "RangeError",		// MRBC_SYMID_RangeError = 40
+  "RuntimeError",	// MRBC_SYMID_RuntimeError = 41
+  "StandardError",	// MRBC_SYMID_StandardError = 42
+  "String",		// MRBC_SYMID_String = 43
+  "Symbol",		// MRBC_SYMID_Symbol = 44
+  "TrueClass",		// MRBC_SYMID_TrueClass = 45
+  "TypeError",		// MRBC_SYMID_TypeError = 46
+  "ZeroDivisionError",	// MRBC_SYMID_ZeroDivisionError = 47
+  "[]",			// MRBC_SYMID_BL_BR = 48
+  "[]=",		// MRBC_SYMID_BL_BR_EQ = 49
+  "^",			// MRBC_SYMID_XOR = 50
+  "abs",		// MRBC_SYMID_abs = 51
+  "acos",		// MRBC_SYMID_acos = 52
+  "acosh",		// MRBC_SYMID_acosh = 53
+  "alive?",		// MRBC_SYMID_alive_Q = 54
+  "all_symbols",	// MRBC_SYMID_all_symbols = 55
+  "asin",		// MRBC_SYMID_asin = 56
+  "asinh",		// MRBC_SYMID_asinh = 57
+  "at",			// MRBC_SYMID_at = 58
+  "atan",		// MRBC_SYMID_atan = 59
+  "atan2",		// MRBC_SYMID_atan2 = 60
+  "atanh",		// MRBC_SYMID_atanh = 61
+  "attr_accessor",	// MRBC_SYMID_attr_accessor = 62
+  "attr_reader",	// MRBC_SYMID_attr_reader = 63
+  "b",			// MRBC_SYMID_b = 64
+  "block_given?",	// MRBC_SYMID_block_given_Q = 65
+  "call",		// MRBC_SYMID_call = 66
+  "cbrt",		// MRBC_SYMID_cbrt = 67
+  "chomp",		// MRBC_SYMID_chomp = 68
+  "chomp!",		// MRBC_SYMID_chomp_E = 69
+  "chr",		// MRBC_SYMID_chr = 70
+  "class",		// MRBC_SYMID_class = 71
+  "clear",		// MRBC_SYMID_clear = 72
+  "collect",		// MRBC_SYMID_collect = 73
+  "collect!",		// MRBC_SYMID_collect_E = 74
+  "cos",		// MRBC_SYMID_cos = 75
+  "cosh",		// MRBC_SYMID_cosh = 76
+  "count",		// MRBC_SYMID_count = 77
+  "delete",		// MRBC_SYMID_delete = 78
+  "delete_at",		// MRBC_SYMID_delete_at = 79
+  "delete_if",		// MRBC_SYMID_delete_if = 80
+  "dup",		// MRBC_SYMID_dup = 81
+  "each",		// MRBC_SYMID_each = 82
+  "each_byte",		// MRBC_SYMID_each_byte = 83
+  "each_char",		// MRBC_SYMID_each_char = 84
+  "each_index",		// MRBC_SYMID_each_index = 85
+  "each_with_index",	// MRBC_SYMID_each_with_index = 86
+  "empty?",		// MRBC_SYMID_empty_Q = 87
+  "end_with?",		// MRBC_SYMID_end_with_Q = 88
+  "erf",		// MRBC_SYMID_erf = 89
+  "erfc",		// MRBC_SYMID_erfc = 90
+  "exclude_end?",	// MRBC_SYMID_exclude_end_Q = 91
+  "exp",		// MRBC_SYMID_exp = 92
+  "first",		// MRBC_SYMID_first = 93
+  "getbyte",		// MRBC_SYMID_getbyte = 94
+  "has_key?",		// MRBC_SYMID_has_key_Q = 95
+  "has_value?",		// MRBC_SYMID_has_value_Q = 96
+  "hypot",		// MRBC_SYMID_hypot = 97
+  "id2name",		// MRBC_SYMID_id2name = 98
+  "include?",		// MRBC_SYMID_include_Q = 99
+  "index",		// MRBC_SYMID_index = 100
+  "initialize",		// MRBC_SYMID_initialize = 101
+  "inspect",		// MRBC_SYMID_inspect = 102
+  "instance_methods",	// MRBC_SYMID_instance_methods = 103
+  "instance_variables",	// MRBC_SYMID_instance_variables = 104
+  "intern",		// MRBC_SYMID_intern = 105
+  "is_a?",		// MRBC_SYMID_is_a_Q = 106
+  "join",		// MRBC_SYMID_join = 107
+  "key",		// MRBC_SYMID_key = 108
+  "keys",		// MRBC_SYMID_keys = 109
+  "kind_of?",		// MRBC_SYMID_kind_of_Q = 110
+  "last",		// MRBC_SYMID_last = 111
+  "ldexp",		// MRBC_SYMID_ldexp = 112
+  "length",		// MRBC_SYMID_length = 113
+  "log",		// MRBC_SYMID_log = 114
+  "log10",		// MRBC_SYMID_log10 = 115
+  "log2",		// MRBC_SYMID_log2 = 116
+  "loop",		// MRBC_SYMID_loop = 117
+  "lstrip",		// MRBC_SYMID_lstrip = 118
+  "lstrip!",		// MRBC_SYMID_lstrip_E = 119
+  "map",		// MRBC_SYMID_map = 120
+  "map!",		// MRBC_SYMID_map_E = 121
+  "max",		// MRBC_SYMID_max = 122
+  "memory_statistics",	// MRBC_SYMID_memory_statistics = 123
+  "merge",		// MRBC_SYMID_merge = 124
+  "merge!",		// MRBC_SYMID_merge_E = 125
+  "message",		// MRBC_SYMID_message = 126
+  "min",		// MRBC_SYMID_min = 127
+  "minmax",		// MRBC_SYMID_minmax = 128
+  "new",		// MRBC_SYMID_new = 129
+  "nil?",		// MRBC_SYMID_nil_Q = 130
+  "object_id",		// MRBC_SYMID_object_id = 131
+  "ord",		// MRBC_SYMID_ord = 132
+  "p",			// MRBC_SYMID_p = 133
+  "pop",		// MRBC_SYMID_pop = 134
+  "print",		// MRBC_SYMID_print = 135
+  "printf",		// MRBC_SYMID_printf = 136
+  "push",		// MRBC_SYMID_push = 137
+  "puts",		// MRBC_SYMID_puts = 138
+  "raise",		// MRBC_SYMID_raise = 139
+  "reject",		// MRBC_SYMID_reject = 140
+  "reject!",		// MRBC_SYMID_reject_E = 141
+  "resume",		// MRBC_SYMID_resume = 142
+  "rstrip",		// MRBC_SYMID_rstrip = 143
+  "rstrip!",		// MRBC_SYMID_rstrip_E = 144
+  "shift",		// MRBC_SYMID_shift = 145
+  "sin",		// MRBC_SYMID_sin = 146
+  "sinh",		// MRBC_SYMID_sinh = 147
+  "size",		// MRBC_SYMID_size = 148
+  "slice!",		// MRBC_SYMID_slice_E = 149
+  "sort",		// MRBC_SYMID_sort = 150
+  "sort!",		// MRBC_SYMID_sort_E = 151
+  "split",		// MRBC_SYMID_split = 152
+  "sprintf",		// MRBC_SYMID_sprintf = 153
+  "sqrt",		// MRBC_SYMID_sqrt = 154
+  "start_with?",	// MRBC_SYMID_start_with_Q = 155
+  "strip",		// MRBC_SYMID_strip = 156
+  "strip!",		// MRBC_SYMID_strip_E = 157
+  "tan",		// MRBC_SYMID_tan = 158
+  "tanh",		// MRBC_SYMID_tanh = 159
+  "times",		// MRBC_SYMID_times = 160
+  "to_a",		// MRBC_SYMID_to_a = 161
+  "to_f",		// MRBC_SYMID_to_f = 162
+  "to_h",		// MRBC_SYMID_to_h = 163
+  "to_i",		// MRBC_SYMID_to_i = 164
+  "to_s",		// MRBC_SYMID_to_s = 165
+  "to_sym",		// MRBC_SYMID_to_sym = 166
+  "tr",			// MRBC_SYMID_tr = 167
+  "tr!",		// MRBC_SYMID_tr_E = 168
+  "unshift",		// MRBC_SYMID_unshift = 169
+  "values",		// MRBC_SYMID_values = 170
+  "yield",		// MRBC_SYMID_yield = 171
+  "|",			// MRBC_SYMID_OR = 172
+  "~",			// MRBC_SYMID_NEG = 173
 };
 #endif
 
@@ -199,155 +203,159 @@ enum {
   MRBC_SYMID_E = 18,
   MRBC_SYMID_Exception = 19,
   MRBC_SYMID_FalseClass = 20,
-  MRBC_SYMID_Float = 21,
-  MRBC_SYMID_Hash = 22,
-  MRBC_SYMID_IndexError = 23,
-  MRBC_SYMID_Integer = 24,
-  MRBC_SYMID_MRUBYC_VERSION = 25,
-  MRBC_SYMID_MRUBY_VERSION = 26,
-  MRBC_SYMID_Math = 27,
-  MRBC_SYMID_NameError = 28,
-  MRBC_SYMID_NilClass = 29,
-  MRBC_SYMID_NoMemoryError = 30,
-  MRBC_SYMID_NoMethodError = 31,
-  MRBC_SYMID_NotImplementedError = 32,
-  MRBC_SYMID_Object = 33,
-  MRBC_SYMID_PI = 34,
-  MRBC_SYMID_Proc = 35,
-  MRBC_SYMID_RUBY_ENGINE = 36,
-  MRBC_SYMID_RUBY_VERSION = 37,
-  MRBC_SYMID_Range = 38,
-  MRBC_SYMID_RangeError = 39,
-  MRBC_SYMID_RuntimeError = 40,
-  MRBC_SYMID_StandardError = 41,
-  MRBC_SYMID_String = 42,
-  MRBC_SYMID_Symbol = 43,
-  MRBC_SYMID_TrueClass = 44,
-  MRBC_SYMID_TypeError = 45,
-  MRBC_SYMID_ZeroDivisionError = 46,
-  MRBC_SYMID_BL_BR = 47,
-  MRBC_SYMID_BL_BR_EQ = 48,
-  MRBC_SYMID_XOR = 49,
-  MRBC_SYMID_abs = 50,
-  MRBC_SYMID_acos = 51,
-  MRBC_SYMID_acosh = 52,
-  MRBC_SYMID_all_symbols = 53,
-  MRBC_SYMID_asin = 54,
-  MRBC_SYMID_asinh = 55,
-  MRBC_SYMID_at = 56,
-  MRBC_SYMID_atan = 57,
-  MRBC_SYMID_atan2 = 58,
-  MRBC_SYMID_atanh = 59,
-  MRBC_SYMID_attr_accessor = 60,
-  MRBC_SYMID_attr_reader = 61,
-  MRBC_SYMID_b = 62,
-  MRBC_SYMID_block_given_Q = 63,
-  MRBC_SYMID_call = 64,
-  MRBC_SYMID_cbrt = 65,
-  MRBC_SYMID_chomp = 66,
-  MRBC_SYMID_chomp_E = 67,
-  MRBC_SYMID_chr = 68,
-  MRBC_SYMID_class = 69,
-  MRBC_SYMID_clear = 70,
-  MRBC_SYMID_collect = 71,
-  MRBC_SYMID_collect_E = 72,
-  MRBC_SYMID_cos = 73,
-  MRBC_SYMID_cosh = 74,
-  MRBC_SYMID_count = 75,
-  MRBC_SYMID_delete = 76,
-  MRBC_SYMID_delete_at = 77,
-  MRBC_SYMID_delete_if = 78,
-  MRBC_SYMID_dup = 79,
-  MRBC_SYMID_each = 80,
-  MRBC_SYMID_each_byte = 81,
-  MRBC_SYMID_each_char = 82,
-  MRBC_SYMID_each_index = 83,
-  MRBC_SYMID_each_with_index = 84,
-  MRBC_SYMID_empty_Q = 85,
-  MRBC_SYMID_end_with_Q = 86,
-  MRBC_SYMID_erf = 87,
-  MRBC_SYMID_erfc = 88,
-  MRBC_SYMID_exclude_end_Q = 89,
-  MRBC_SYMID_exp = 90,
-  MRBC_SYMID_first = 91,
-  MRBC_SYMID_getbyte = 92,
-  MRBC_SYMID_has_key_Q = 93,
-  MRBC_SYMID_has_value_Q = 94,
-  MRBC_SYMID_hypot = 95,
-  MRBC_SYMID_id2name = 96,
-  MRBC_SYMID_include_Q = 97,
-  MRBC_SYMID_index = 98,
-  MRBC_SYMID_initialize = 99,
-  MRBC_SYMID_inspect = 100,
-  MRBC_SYMID_instance_methods = 101,
-  MRBC_SYMID_instance_variables = 102,
-  MRBC_SYMID_intern = 103,
-  MRBC_SYMID_is_a_Q = 104,
-  MRBC_SYMID_join = 105,
-  MRBC_SYMID_key = 106,
-  MRBC_SYMID_keys = 107,
-  MRBC_SYMID_kind_of_Q = 108,
-  MRBC_SYMID_last = 109,
-  MRBC_SYMID_ldexp = 110,
-  MRBC_SYMID_length = 111,
-  MRBC_SYMID_log = 112,
-  MRBC_SYMID_log10 = 113,
-  MRBC_SYMID_log2 = 114,
-  MRBC_SYMID_loop = 115,
-  MRBC_SYMID_lstrip = 116,
-  MRBC_SYMID_lstrip_E = 117,
-  MRBC_SYMID_map = 118,
-  MRBC_SYMID_map_E = 119,
-  MRBC_SYMID_max = 120,
-  MRBC_SYMID_memory_statistics = 121,
-  MRBC_SYMID_merge = 122,
-  MRBC_SYMID_merge_E = 123,
-  MRBC_SYMID_message = 124,
-  MRBC_SYMID_min = 125,
-  MRBC_SYMID_minmax = 126,
-  MRBC_SYMID_new = 127,
-  MRBC_SYMID_nil_Q = 128,
-  MRBC_SYMID_object_id = 129,
-  MRBC_SYMID_ord = 130,
-  MRBC_SYMID_p = 131,
-  MRBC_SYMID_pop = 132,
-  MRBC_SYMID_print = 133,
-  MRBC_SYMID_printf = 134,
-  MRBC_SYMID_push = 135,
-  MRBC_SYMID_puts = 136,
-  MRBC_SYMID_raise = 137,
-  MRBC_SYMID_reject = 138,
-  MRBC_SYMID_reject_E = 139,
-  MRBC_SYMID_rstrip = 140,
-  MRBC_SYMID_rstrip_E = 141,
-  MRBC_SYMID_shift = 142,
-  MRBC_SYMID_sin = 143,
-  MRBC_SYMID_sinh = 144,
-  MRBC_SYMID_size = 145,
-  MRBC_SYMID_slice_E = 146,
-  MRBC_SYMID_sort = 147,
-  MRBC_SYMID_sort_E = 148,
-  MRBC_SYMID_split = 149,
-  MRBC_SYMID_sprintf = 150,
-  MRBC_SYMID_sqrt = 151,
-  MRBC_SYMID_start_with_Q = 152,
-  MRBC_SYMID_strip = 153,
-  MRBC_SYMID_strip_E = 154,
-  MRBC_SYMID_tan = 155,
-  MRBC_SYMID_tanh = 156,
-  MRBC_SYMID_times = 157,
-  MRBC_SYMID_to_a = 158,
-  MRBC_SYMID_to_f = 159,
-  MRBC_SYMID_to_h = 160,
-  MRBC_SYMID_to_i = 161,
-  MRBC_SYMID_to_s = 162,
-  MRBC_SYMID_to_sym = 163,
-  MRBC_SYMID_tr = 164,
-  MRBC_SYMID_tr_E = 165,
-  MRBC_SYMID_unshift = 166,
-  MRBC_SYMID_values = 167,
-  MRBC_SYMID_OR = 168,
-  MRBC_SYMID_NEG = 169,
+  MRBC_SYMID_Fiber = 21,
+  MRBC_SYMID_Float = 22,
+  MRBC_SYMID_Hash = 23,
+  MRBC_SYMID_IndexError = 24,
+  MRBC_SYMID_Integer = 25,
+  MRBC_SYMID_MRUBYC_VERSION = 26,
+  MRBC_SYMID_MRUBY_VERSION = 27,
+  MRBC_SYMID_Math = 28,
+  MRBC_SYMID_NameError = 29,
+  MRBC_SYMID_NilClass = 30,
+  MRBC_SYMID_NoMemoryError = 31,
+  MRBC_SYMID_NoMethodError = 32,
+  MRBC_SYMID_NotImplementedError = 33,
+  MRBC_SYMID_Object = 34,
+  MRBC_SYMID_PI = 35,
+  MRBC_SYMID_Proc = 36,
+  MRBC_SYMID_RUBY_ENGINE = 37,
+  MRBC_SYMID_RUBY_VERSION = 38,
+  MRBC_SYMID_Range = 39,
+  MRBC_SYMID_RangeError = 40,
+  MRBC_SYMID_RuntimeError = 41,
+  MRBC_SYMID_StandardError = 42,
+  MRBC_SYMID_String = 43,
+  MRBC_SYMID_Symbol = 44,
+  MRBC_SYMID_TrueClass = 45,
+  MRBC_SYMID_TypeError = 46,
+  MRBC_SYMID_ZeroDivisionError = 47,
+  MRBC_SYMID_BL_BR = 48,
+  MRBC_SYMID_BL_BR_EQ = 49,
+  MRBC_SYMID_XOR = 50,
+  MRBC_SYMID_abs = 51,
+  MRBC_SYMID_acos = 52,
+  MRBC_SYMID_acosh = 53,
+  MRBC_SYMID_alive_Q = 54,
+  MRBC_SYMID_all_symbols = 55,
+  MRBC_SYMID_asin = 56,
+  MRBC_SYMID_asinh = 57,
+  MRBC_SYMID_at = 58,
+  MRBC_SYMID_atan = 59,
+  MRBC_SYMID_atan2 = 60,
+  MRBC_SYMID_atanh = 61,
+  MRBC_SYMID_attr_accessor = 62,
+  MRBC_SYMID_attr_reader = 63,
+  MRBC_SYMID_b = 64,
+  MRBC_SYMID_block_given_Q = 65,
+  MRBC_SYMID_call = 66,
+  MRBC_SYMID_cbrt = 67,
+  MRBC_SYMID_chomp = 68,
+  MRBC_SYMID_chomp_E = 69,
+  MRBC_SYMID_chr = 70,
+  MRBC_SYMID_class = 71,
+  MRBC_SYMID_clear = 72,
+  MRBC_SYMID_collect = 73,
+  MRBC_SYMID_collect_E = 74,
+  MRBC_SYMID_cos = 75,
+  MRBC_SYMID_cosh = 76,
+  MRBC_SYMID_count = 77,
+  MRBC_SYMID_delete = 78,
+  MRBC_SYMID_delete_at = 79,
+  MRBC_SYMID_delete_if = 80,
+  MRBC_SYMID_dup = 81,
+  MRBC_SYMID_each = 82,
+  MRBC_SYMID_each_byte = 83,
+  MRBC_SYMID_each_char = 84,
+  MRBC_SYMID_each_index = 85,
+  MRBC_SYMID_each_with_index = 86,
+  MRBC_SYMID_empty_Q = 87,
+  MRBC_SYMID_end_with_Q = 88,
+  MRBC_SYMID_erf = 89,
+  MRBC_SYMID_erfc = 90,
+  MRBC_SYMID_exclude_end_Q = 91,
+  MRBC_SYMID_exp = 92,
+  MRBC_SYMID_first = 93,
+  MRBC_SYMID_getbyte = 94,
+  MRBC_SYMID_has_key_Q = 95,
+  MRBC_SYMID_has_value_Q = 96,
+  MRBC_SYMID_hypot = 97,
+  MRBC_SYMID_id2name = 98,
+  MRBC_SYMID_include_Q = 99,
+  MRBC_SYMID_index = 100,
+  MRBC_SYMID_initialize = 101,
+  MRBC_SYMID_inspect = 102,
+  MRBC_SYMID_instance_methods = 103,
+  MRBC_SYMID_instance_variables = 104,
+  MRBC_SYMID_intern = 105,
+  MRBC_SYMID_is_a_Q = 106,
+  MRBC_SYMID_join = 107,
+  MRBC_SYMID_key = 108,
+  MRBC_SYMID_keys = 109,
+  MRBC_SYMID_kind_of_Q = 110,
+  MRBC_SYMID_last = 111,
+  MRBC_SYMID_ldexp = 112,
+  MRBC_SYMID_length = 113,
+  MRBC_SYMID_log = 114,
+  MRBC_SYMID_log10 = 115,
+  MRBC_SYMID_log2 = 116,
+  MRBC_SYMID_loop = 117,
+  MRBC_SYMID_lstrip = 118,
+  MRBC_SYMID_lstrip_E = 119,
+  MRBC_SYMID_map = 120,
+  MRBC_SYMID_map_E = 121,
+  MRBC_SYMID_max = 122,
+  MRBC_SYMID_memory_statistics = 123,
+  MRBC_SYMID_merge = 124,
+  MRBC_SYMID_merge_E = 125,
+  MRBC_SYMID_message = 126,
+  MRBC_SYMID_min = 127,
+  MRBC_SYMID_minmax = 128,
+  MRBC_SYMID_new = 129,
+  MRBC_SYMID_nil_Q = 130,
+  MRBC_SYMID_object_id = 131,
+  MRBC_SYMID_ord = 132,
+  MRBC_SYMID_p = 133,
+  MRBC_SYMID_pop = 134,
+  MRBC_SYMID_print = 135,
+  MRBC_SYMID_printf = 136,
+  MRBC_SYMID_push = 137,
+  MRBC_SYMID_puts = 138,
+  MRBC_SYMID_raise = 139,
+  MRBC_SYMID_reject = 140,
+  MRBC_SYMID_reject_E = 141,
+  MRBC_SYMID_resume = 142,
+  MRBC_SYMID_rstrip = 143,
+  MRBC_SYMID_rstrip_E = 144,
+  MRBC_SYMID_shift = 145,
+  MRBC_SYMID_sin = 146,
+  MRBC_SYMID_sinh = 147,
+  MRBC_SYMID_size = 148,
+  MRBC_SYMID_slice_E = 149,
+  MRBC_SYMID_sort = 150,
+  MRBC_SYMID_sort_E = 151,
+  MRBC_SYMID_split = 152,
+  MRBC_SYMID_sprintf = 153,
+  MRBC_SYMID_sqrt = 154,
+  MRBC_SYMID_start_with_Q = 155,
+  MRBC_SYMID_strip = 156,
+  MRBC_SYMID_strip_E = 157,
+  MRBC_SYMID_tan = 158,
+  MRBC_SYMID_tanh = 159,
+  MRBC_SYMID_times = 160,
+  MRBC_SYMID_to_a = 161,
+  MRBC_SYMID_to_f = 162,
+  MRBC_SYMID_to_h = 163,
+  MRBC_SYMID_to_i = 164,
+  MRBC_SYMID_to_s = 165,
+  MRBC_SYMID_to_sym = 166,
+  MRBC_SYMID_tr = 167,
+  MRBC_SYMID_tr_E = 168,
+  MRBC_SYMID_unshift = 169,
+  MRBC_SYMID_values = 170,
+  MRBC_SYMID_yield = 171,
+  MRBC_SYMID_OR = 172,
+  MRBC_SYMID_NEG = 173,
 };
 
 #define MRB_SYM(sym)  MRBC_SYMID_##sym
@@ -0,0 +1,26 @@
+/* Auto generated by make_method_table.rb */
+#include "_autogen_builtin_symbol.h"
+
+/*===== Fiber class =====*/
+static const mrbc_sym method_symbols_Fiber[] = {
+  MRBC_SYM(alive_Q),
+  MRBC_SYM(new),
+  MRBC_SYM(resume),
+  MRBC_SYM(yield),
+};
+
+static const mrbc_func_t method_functions_Fiber[] = {
+  c_fiber_alive,
+  c_fiber_new,
+  c_fiber_resume,
+  c_fiber_yield,
+};
+
+struct RBuiltinClass mrbc_class_Fiber = {
+  .sym_id = MRBC_SYM(Fiber),
+  .num_builtin_method = sizeof(method_symbols_Fiber) / sizeof(mrbc_sym),
+  .super = MRBC_CLASS(Object),
+  .method_link = 0,
+  .method_symbols = method_symbols_Fiber,
+  .method_functions = method_functions_Fiber,
+};
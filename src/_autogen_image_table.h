@@ -0,0 +1,215 @@
+/* Auto generated by make_image_table.rb */
+#ifndef MEGAMRBC_SRC_AUTOGEN_IMAGE_TABLE_H_
+#define MEGAMRBC_SRC_AUTOGEN_IMAGE_TABLE_H_
+
+static const struct IMAGE_TABLE {
+  const char *name;
+  const Image *image;
+} image_table[] = {
+  {"SGDK", &SGDK},			// IMAGE_ID_SGDK = 0
+  {"aboutme", &aboutme},		// IMAGE_ID_aboutme = 1
+  {"adl_bkk", &adl_bkk},		// IMAGE_ID_adl_bkk = 2
+  {"adl_bkk_br", &adl_bkk_br},		// IMAGE_ID_adl_bkk_br = 3
+  {"adl_mel", &adl_mel},		// IMAGE_ID_adl_mel = 4
+  {"adl_mel_br", &adl_mel_br},		// IMAGE_ID_adl_mel_br = 5
+  {"c_klog", &c_klog},			// IMAGE_ID_c_klog = 6
+  {"calling_from_ruby", &calling_from_ruby},	// IMAGE_ID_calling_from_ruby = 7
+  {"cipherstash", &cipherstash},	// IMAGE_ID_cipherstash = 8
+  {"custom_font", &custom_font},	// IMAGE_ID_custom_font = 9
+  {"d000", &dev_proc_000},		// IMAGE_ID_d000 = 10
+  {"d001", &dev_proc_001},		// IMAGE_ID_d001 = 11
+  {"d002", &dev_proc_002},		// IMAGE_ID_d002 = 12
+  {"d003", &dev_proc_003},		// IMAGE_ID_d003 = 13
+  {"d004", &dev_proc_004},		// IMAGE_ID_d004 = 14
+  {"d005", &dev_proc_005},		// IMAGE_ID_d005 = 15
+  {"d006", &dev_proc_006},		// IMAGE_ID_d006 = 16
+  {"d007", &dev_proc_007},		// IMAGE_ID_d007 = 17
+  {"d008", &dev_proc_008},		// IMAGE_ID_d008 = 18
+  {"define_ruby_methods", &define_ruby_methods},	// IMAGE_ID_define_ruby_methods = 19
+  {"dev_proc_000", &dev_proc_000},	// IMAGE_ID_dev_proc_000 = 20
+  {"dev_proc_001", &dev_proc_001},	// IMAGE_ID_dev_proc_001 = 21
+  {"dev_proc_002", &dev_proc_002},	// IMAGE_ID_dev_proc_002 = 22
+  {"dev_proc_003", &dev_proc_003},	// IMAGE_ID_dev_proc_003 = 23
+  {"dev_proc_004", &dev_proc_004},	// IMAGE_ID_dev_proc_004 = 24
+  {"dev_proc_005", &dev_proc_005},	// IMAGE_ID_dev_proc_005 = 25
+  {"dev_proc_006", &dev_proc_006},	// IMAGE_ID_dev_proc_006 = 26
+  {"dev_proc_007", &dev_proc_007},	// IMAGE_ID_dev_proc_007 = 27
+  {"dev_proc_008", &dev_proc_008},	// IMAGE_ID_dev_proc_008 = 28
+  {"dev_w_mrubyc_000", &dev_w_mrubyc_000},	// IMAGE_ID_dev_w_mrubyc_000 = 29
+  {"dev_w_mrubyc_001", &dev_w_mrubyc_001},	// IMAGE_ID_dev_w_mrubyc_001 = 30
+  {"dev_w_mrubyc_002", &dev_w_mrubyc_002},	// IMAGE_ID_dev_w_mrubyc_002 = 31
+  {"dev_w_mrubyc_003", &dev_w_mrubyc_003},	// IMAGE_ID_dev_w_mrubyc_003 = 32
+  {"dev_w_mrubyc_004", &dev_w_mrubyc_004},	// IMAGE_ID_dev_w_mrubyc_004 = 33
+  {"dev_w_mrubyc_005", &dev_w_mrubyc_005},	// IMAGE_ID_dev_w_mrubyc_005 = 34
+  {"dev_w_mrubyc_006", &dev_w_mrubyc_006},	// IMAGE_ID_dev_w_mrubyc_006 = 35
+  {"dev_w_mrubyc_007", &dev_w_mrubyc_007},	// IMAGE_ID_dev_w_mrubyc_007 = 36
+  {"dev_w_mrubyc_008", &dev_w_mrubyc_008},	// IMAGE_ID_dev_w_mrubyc_008 = 37
+  {"dev_w_mrubyc_009", &dev_w_mrubyc_009},	// IMAGE_ID_dev_w_mrubyc_009 = 38
+  {"dev_w_mrubyc_010", &dev_w_mrubyc_010},	// IMAGE_ID_dev_w_mrubyc_010 = 39
+  {"dev_w_mrubyc_011", &dev_w_mrubyc_011},	// IMAGE_ID_dev_w_mrubyc_011 = 40
+  {"dev_w_mrubyc_012", &dev_w_mrubyc_012},	// IMAGE_ID_dev_w_mrubyc_012 = 41
+  {"emulators", &emulators},		// IMAGE_ID_emulators = 42
+  {"m000", &dev_w_mrubyc_000},		// IMAGE_ID_m000 = 43
+  {"m001", &dev_w_mrubyc_001},		// IMAGE_ID_m001 = 44
+  {"m002", &dev_w_mrubyc_002},		// IMAGE_ID_m002 = 45
+  {"m003", &dev_w_mrubyc_003},		// IMAGE_ID_m003 = 46
+  {"m004", &dev_w_mrubyc_004},		// IMAGE_ID_m004 = 47
+  {"m005", &dev_w_mrubyc_005},		// IMAGE_ID_m005 = 48
+  {"m006", &dev_w_mrubyc_006},		// IMAGE_ID_m006 = 49
+  {"m007", &dev_w_mrubyc_007},		// IMAGE_ID_m007 = 50
+  {"m008", &dev_w_mrubyc_008},		// IMAGE_ID_m008 = 51
+  {"m009", &dev_w_mrubyc_009},		// IMAGE_ID_m009 = 52
+  {"m010", &dev_w_mrubyc_010},		// IMAGE_ID_m010 = 53
+  {"m011", &dev_w_mrubyc_011},		// IMAGE_ID_m011 = 54
+  {"m012", &dev_w_mrubyc_012},		// IMAGE_ID_m012 = 55
+  {"main_logo", &main_logo},		// IMAGE_ID_main_logo = 56
+  {"main_logo_dash", &main_logo_dash},	// IMAGE_ID_main_logo_dash = 57
+  {"main_logo_dashplus", &main_logo_dashplus},	// IMAGE_ID_main_logo_dashplus = 58
+  {"mainloop", &mainloop},		// IMAGE_ID_mainloop = 59
+  {"mdchallenges", &mdchallenges},	// IMAGE_ID_mdchallenges = 60
+  {"mdgraphic", &mdgraphic},		// IMAGE_ID_mdgraphic = 61
+  {"mountains_bg", &mountains_bg},	// IMAGE_ID_mountains_bg = 62
+  {"mrbld_000", &mrubyloading_000},	// IMAGE_ID_mrbld_000 = 63
+  {"mrbld_001", &mrubyloading_001},	// IMAGE_ID_mrbld_001 = 64
+  {"mrbld_002", &mrubyloading_002},	// IMAGE_ID_mrbld_002 = 65
+  {"mrbld_003", &mrubyloading_003},	// IMAGE_ID_mrbld_003 = 66
+  {"mrbld_004", &mrubyloading_004},	// IMAGE_ID_mrbld_004 = 67
+  {"mrubykaigi", &mrubykaigi},		// IMAGE_ID_mrubykaigi = 68
+  {"mrubyloading_000", &mrubyloading_000},	// IMAGE_ID_mrubyloading_000 = 69
+  {"mrubyloading_001", &mrubyloading_001},	// IMAGE_ID_mrubyloading_001 = 70
+  {"mrubyloading_002", &mrubyloading_002},	// IMAGE_ID_mrubyloading_002 = 71
+  {"mrubyloading_003", &mrubyloading_003},	// IMAGE_ID_mrubyloading_003 = 72
+  {"mrubyloading_004", &mrubyloading_004},	// IMAGE_ID_mrubyloading_004 = 73
+  {"resource_usage000", &resource_usage000},	// IMAGE_ID_resource_usage000 = 74
+  {"resource_usage001", &resource_usage001},	// IMAGE_ID_resource_usage001 = 75
+  {"resource_usage002", &resource_usage002},	// IMAGE_ID_resource_usage002 = 76
+  {"resource_usage003", &resource_usage003},	// IMAGE_ID_resource_usage003 = 77
+  {"resource_usage004", &resource_usage004},	// IMAGE_ID_resource_usage004 = 78
+  {"ru000", &resource_usage000},	// IMAGE_ID_ru000 = 79
+  {"ru001", &resource_usage001},	// IMAGE_ID_ru001 = 80
+  {"ru002", &resource_usage002},	// IMAGE_ID_ru002 = 81
+  {"ru003", &resource_usage003},	// IMAGE_ID_ru003 = 82
+  {"ru004", &resource_usage004},	// IMAGE_ID_ru004 = 83
+  {"ruby", &ruby},			// IMAGE_ID_ruby = 84
+  {"rubyconfau", &rubyconfau},		// IMAGE_ID_rubyconfau = 85
+  {"rubyconfth", &rubyconfth},		// IMAGE_ID_rubyconfth = 86
+  {"rubykaigi", &rubykaigi},		// IMAGE_ID_rubykaigi = 87
+  {"sgdkmrbc", &sgdkmrbc},		// IMAGE_ID_sgdkmrbc = 88
+  {"sky_bg", &sky_bg},			// IMAGE_ID_sky_bg = 89
+  {"slide_ex000", &slide_ex000},	// IMAGE_ID_slide_ex000 = 90
+  {"slide_ex001", &slide_ex001},	// IMAGE_ID_slide_ex001 = 91
+  {"slide_ex002", &slide_ex002},	// IMAGE_ID_slide_ex002 = 92
+  {"whatsmd", &whatsmd},		// IMAGE_ID_whatsmd = 93
+  {"whatsmruby", &whatsmruby},		// IMAGE_ID_whatsmruby = 94
+  {"whatsmrubyc", &whatsmrubyc},	// IMAGE_ID_whatsmrubyc = 95
+  {"whymd", &whymd},			// IMAGE_ID_whymd = 96
+  {"whymrubyconmd", &whymrubyconmd},	// IMAGE_ID_whymrubyconmd = 97
+  {"yuji", &yuji},			// IMAGE_ID_yuji = 98
+  {"yuji_br", &yuji_br},		// IMAGE_ID_yuji_br = 99
+};
+
+enum {
+  IMAGE_ID_SGDK = 0,
+  IMAGE_ID_aboutme = 1,
+  IMAGE_ID_adl_bkk = 2,
+  IMAGE_ID_adl_bkk_br = 3,
+  IMAGE_ID_adl_mel = 4,
+  IMAGE_ID_adl_mel_br = 5,
+  IMAGE_ID_c_klog = 6,
+  IMAGE_ID_calling_from_ruby = 7,
+  IMAGE_ID_cipherstash = 8,
+  IMAGE_ID_custom_font = 9,
+  IMAGE_ID_d000 = 10,
+  IMAGE_ID_d001 = 11,
+  IMAGE_ID_d002 = 12,
+  IMAGE_ID_d003 = 13,
+  IMAGE_ID_d004 = 14,
+  IMAGE_ID_d005 = 15,
+  IMAGE_ID_d006 = 16,
+  IMAGE_ID_d007 = 17,
+  IMAGE_ID_d008 = 18,
+  IMAGE_ID_define_ruby_methods = 19,
+  IMAGE_ID_dev_proc_000 = 20,
+  IMAGE_ID_dev_proc_001 = 21,
+  IMAGE_ID_dev_proc_002 = 22,
+  IMAGE_ID_dev_proc_003 = 23,
+  IMAGE_ID_dev_proc_004 = 24,
+  IMAGE_ID_dev_proc_005 = 25,
+  IMAGE_ID_dev_proc_006 = 26,
+  IMAGE_ID_dev_proc_007 = 27,
+  IMAGE_ID_dev_proc_008 = 28,
+  IMAGE_ID_dev_w_mrubyc_000 = 29,
+  IMAGE_ID_dev_w_mrubyc_001 = 30,
+  IMAGE_ID_dev_w_mrubyc_002 = 31,
+  IMAGE_ID_dev_w_mrubyc_003 = 32,
+  IMAGE_ID_dev_w_mrubyc_004 = 33,
+  IMAGE_ID_dev_w_mrubyc_005 = 34,
+  IMAGE_ID_dev_w_mrubyc_006 = 35,
+  IMAGE_ID_dev_w_mrubyc_007 = 36,
+  IMAGE_ID_dev_w_mrubyc_008 = 37,
+  IMAGE_ID_dev_w_mrubyc_009 = 38,
+  IMAGE_ID_dev_w_mrubyc_010 = 39,
+  IMAGE_ID_dev_w_mrubyc_011 = 40,
+  IMAGE_ID_dev_w_mrubyc_012 = 41,
+  IMAGE_ID_emulators = 42,
+  IMAGE_ID_m000 = 43,
+  IMAGE_ID_m001 = 44,
+  IMAGE_ID_m002 = 45,
+  IMAGE_ID_m003 = 46,
+  IMAGE_ID_m004 = 47,
+  IMAGE_ID_m005 = 48,
+  IMAGE_ID_m006 = 49,
+  IMAGE_ID_m007 = 50,
+  IMAGE_ID_m008 = 51,
+  IMAGE_ID_m009 = 52,
+  IMAGE_ID_m010 = 53,
+  IMAGE_ID_m011 = 54,
+  IMAGE_ID_m012 = 55,
+  IMAGE_ID_main_logo = 56,
+  IMAGE_ID_main_logo_dash = 57,
+  IMAGE_ID_main_logo_dashplus = 58,
+  IMAGE_ID_mainloop = 59,
+  IMAGE_ID_mdchallenges = 60,
+  IMAGE_ID_mdgraphic = 61,
+  IMAGE_ID_mountains_bg = 62,
+  IMAGE_ID_mrbld_000 = 63,
+  IMAGE_ID_mrbld_001 = 64,
+  IMAGE_ID_mrbld_002 = 65,
+  IMAGE_ID_mrbld_003 = 66,
+  IMAGE_ID_mrbld_004 = 67,
+  IMAGE_ID_mrubykaigi = 68,
+  IMAGE_ID_mrubyloading_000 = 69,
+  IMAGE_ID_mrubyloading_001 = 70,
+  IMAGE_ID_mrubyloading_002 = 71,
+  IMAGE_ID_mrubyloading_003 = 72,
+  IMAGE_ID_mrubyloading_004 = 73,
+  IMAGE_ID_resource_usage000 = 74,
+  IMAGE_ID_resource_usage001 = 75,
+  IMAGE_ID_resource_usage002 = 76,
+  IMAGE_ID_resource_usage003 = 77,
+  IMAGE_ID_resource_usage004 = 78,
+  IMAGE_ID_ru000 = 79,
+  IMAGE_ID_ru001 = 80,
+  IMAGE_ID_ru002 = 81,
+  IMAGE_ID_ru003 = 82,
+  IMAGE_ID_ru004 = 83,
+  IMAGE_ID_ruby = 84,
+  IMAGE_ID_rubyconfau = 85,
+  IMAGE_ID_rubyconfth = 86,
+  IMAGE_ID_rubykaigi = 87,
+  IMAGE_ID_sgdkmrbc = 88,
+  IMAGE_ID_sky_bg = 89,
+  IMAGE_ID_slide_ex000 = 90,
+  IMAGE_ID_slide_ex001 = 91,
+  IMAGE_ID_slide_ex002 = 92,
+  IMAGE_ID_whatsmd = 93,
+  IMAGE_ID_whatsmruby = 94,
+  IMAGE_ID_whatsmrubyc = 95,
+  IMAGE_ID_whymd = 96,
+  IMAGE_ID_whymrubyconmd = 97,
+  IMAGE_ID_yuji = 98,
+  IMAGE_ID_yuji_br = 99,
+};
+
+#define IMAGE_TABLE_SIZE 100
+#endif
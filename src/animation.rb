@@ -0,0 +1,38 @@
+# Full screen background animations. Runs as a task of its own (see
+# mrubyc() in main.c). Each animation is a Fiber that draws a frame and
+# yields, and the loop below resumes the one Presentation selects in
+# $animation every frame.
+title = Fiber.new do
+  count = 0
+  while true do
+    MegaMrbc.scroll_title
+    if count == 0 # "Press start" blinks every 0.5s
+      MegaMrbc.draw_text("           ", 14, 18)
+    elsif count == 30
+      MegaMrbc.draw_text("Press start", 14, 18)
+    end
+    count = (count + 1) % 60
+    Fiber.yield
+  end
+end
+
+scroll = Fiber.new do
+  while true do
+    MegaMrbc.scroll_weird
+    Fiber.yield
+  end
+end
+
+game = Fiber.new do
+  while true do
+    MegaMrbc.scroll_game
+    Fiber.yield
+  end
+end
+
+animations = { :title => title, :scroll => scroll, :game => game }
+while true do
+  fiber = animations[$animation]
+  fiber.resume if fiber
+  MegaMrbc.wait_vblank
+end
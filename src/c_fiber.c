@@ -0,0 +1,301 @@
+/*! @file
+  @brief
+  mruby/c Fiber class
+
+  <pre>
+  Copyright (C) 2015-2022 Kyushu Institute of Technology.
+  Copyright (C) 2015-2022 Shimane IT Open-Innovation Center.
+
+  This file is distributed under BSD 3-Clause License.
+
+  A Fiber runs its block in its own small VM (registers and CALLINFO
+  stack). Fiber#resume runs that VM inside the method call, until the
+  block calls Fiber.yield or finishes, so a switch costs about as much
+  as a method call, and nothing is copied.
+
+  (note)
+  Like any block, the block can see the local variables of the method
+  that created it only while that method is running.
+  break and return in the block are not supported.
+  </pre>
+*/
+
+
+/***** Feature test switches ************************************************/
+/***** System headers *******************************************************/
+//@cond
+#include "vm_config.h"
+#include <types.h>
+#include <string.h>
+//@endcond
+
+/***** Local headers ********************************************************/
+#include "alloc.h"
+#include "value.h"
+#include "class.h"
+#include "error.h"
+#include "c_array.h"
+#include "opcode.h"
+#include "vm.h"
+#include "c_fiber.h"
+
+/***** Constat values *******************************************************/
+/***** Macros ***************************************************************/
+/***** Typedefs *************************************************************/
+/***** Function prototypes **************************************************/
+/***** Local variables ******************************************************/
+//! bottom of the CALLINFO stack of a Fiber. the block returns to OP_STOP.
+static const uint8_t fiber_stop_inst[] = { OP_STOP };
+static const mrbc_irep fiber_stop_irep = {
+#if defined(MRBC_DEBUG)
+  .type = {'R', 'P'},
+#endif
+  .nregs = 1,
+  .ilen = sizeof(fiber_stop_inst),
+  .inst = fiber_stop_inst,
+};
+
+
+/***** Global variables *****************************************************/
+/***** Signal catching functions ********************************************/
+/***** Local functions ******************************************************/
+//================================================================
+/*! get the Fiber of the object.
+*/
+static inline mrbc_fiber *fiber_of( const mrbc_value *v )
+{
+  return *(mrbc_fiber **)v->instance->data;
+}
+
+
+//================================================================
+/*! arguments of resume and Fiber.yield, as one value.
+
+  @return	nil, the argument, or an Array of the arguments.
+*/
+static mrbc_value fiber_args( struct VM *vm, mrbc_value v[], int argc )
+{
+  if( argc == 0 ) return mrbc_nil_value();
+  if( argc == 1 ) {
+    mrbc_incref( &v[1] );
+    return v[1];
+  }
+
+  mrbc_value ary = mrbc_array_new( vm, argc );
+  if( !ary.array ) return mrbc_nil_value();	// ENOMEM
+
+  int i;
+  for( i = 1; i <= argc; i++ ) {
+    mrbc_incref( &v[i] );
+    mrbc_array_push( &ary, &v[i] );
+  }
+  return ary;
+}
+
+
+//================================================================
+/*! release the registers of a finished Fiber.
+*/
+static void fiber_terminate( mrbc_fiber *fiber )
+{
+  mrbc_vm *vm = &fiber->vm;
+  int i;
+  for( i = 0; i < vm->regs_size; i++ ) {
+    mrbc_decref_empty( &vm->regs[i] );
+  }
+  vm->callinfo_tail = NULL;
+  vm->flag_stop = 1;
+}
+
+
+/***** Global functions *****************************************************/
+//================================================================
+/*! Fiber destructor
+
+  @param  v	pointer to the Fiber object.
+*/
+void mrbc_fiber_delete(mrbc_value *v)
+{
+  mrbc_fiber *fiber = fiber_of(v);
+  if( !fiber ) return;
+
+  fiber_terminate( fiber );
+  mrbc_decref( &fiber->ret );
+  mrbc_raw_free( fiber );
+}
+
+
+//================================================================
+/*! (method) new
+*/
+static void c_fiber_new(struct VM *vm, mrbc_value v[], int argc)
+{
+  if( mrbc_type(v[1]) != MRBC_TT_PROC ) {
+    mrbc_raise(vm, MRBC_CLASS(ArgumentError),
+	       "tried to create Fiber object without a block");
+    return;
+  }
+
+  mrbc_value obj = mrbc_instance_new(vm, MRBC_CLASS(Fiber), sizeof(mrbc_fiber *));
+  if( !obj.instance ) return;	// ENOMEM
+  *(mrbc_fiber **)obj.instance->data = NULL;
+
+  mrbc_fiber *fiber = mrbc_raw_alloc( sizeof(mrbc_fiber) );
+  if( !fiber ) {		// ENOMEM
+    mrbc_decref( &obj );
+    return;
+  }
+  memset( fiber, 0, sizeof(mrbc_fiber) );
+  fiber->ret = mrbc_nil_value();
+
+  mrbc_vm *fvm = &fiber->vm;
+#if defined(MRBC_DEBUG)
+  memcpy(fvm->type, "VM", 2);
+#endif
+  fvm->vm_id = vm->vm_id;
+  fvm->flag_fiber = 1;
+  mrbc_vm_set_stack( fvm, fiber->regs, MAX_FIBER_REGS_SIZE,
+		     fiber->callinfo, MAX_FIBER_CALLINFO_COUNT );
+  fvm->top_regs = vm->top_regs;
+  fvm->cur_irep = &fiber_stop_irep;
+  fvm->inst = fiber_stop_irep.inst;
+  fvm->cur_regs = fvm->regs;
+  fvm->target_class = vm->target_class;
+  fvm->exception = mrbc_nil_value();
+
+  // R[0] is the block, as in Proc#call.
+  fvm->regs[0] = v[1];
+  v[1].tt = MRBC_TT_EMPTY;
+  int i;
+  for( i = 1; i < fvm->regs_size; i++ ) {
+    fvm->regs[i] = mrbc_nil_value();
+  }
+
+  *(mrbc_fiber **)obj.instance->data = fiber;
+  SET_RETURN(obj);
+}
+
+
+//================================================================
+/*! (method) resume
+*/
+static void c_fiber_resume(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_fiber *fiber = fiber_of(&v[0]);
+  mrbc_vm *fvm = &fiber->vm;
+
+  if( fvm->flag_stop ) {
+    mrbc_raise(vm, MRBC_CLASS(RuntimeError), "dead fiber called");
+    return;
+  }
+  if( fiber->resumer ) {
+    mrbc_raise(vm, MRBC_CLASS(RuntimeError), "attempt to resume a resuming fiber");
+    return;
+  }
+
+  if( !fvm->callinfo_tail ) {
+    // the first resume calls the block with the arguments.
+    if( argc >= fvm->regs_size ) {
+      mrbc_raise(vm, MRBC_CLASS(ArgumentError), "too many arguments");
+      return;
+    }
+    // OP_ENTER checks the registers, but a block without parameters
+    // has no OP_ENTER.
+    mrbc_proc *proc = fvm->regs[0].proc;
+    if( proc->irep->nregs >= fvm->regs_size ) {
+      mrbc_raise(vm, MRBC_CLASS(RuntimeError), "MAX_FIBER_REGS_SIZE overflow.");
+      return;
+    }
+    int i;
+    for( i = 1; i <= argc; i++ ) {
+      mrbc_incref( &v[i] );
+      fvm->regs[i] = v[i];
+    }
+
+    mrbc_callinfo *callinfo_self = proc->callinfo_self;
+    mrbc_callinfo *callinfo = mrbc_push_callinfo(fvm,
+				(callinfo_self ? callinfo_self->method_id : 0),
+				0, argc);
+    if( callinfo_self ) {
+      callinfo->own_class = callinfo_self->own_class;
+    }
+    fvm->cur_irep = proc->irep;
+    fvm->inst = fvm->cur_irep->inst;
+    fvm->cur_regs = fvm->regs;
+
+  } else {
+    // the arguments are the return value of Fiber.yield
+    mrbc_decref( fiber->yield_ret );
+    *fiber->yield_ret = fiber_args( vm, v, argc );
+  }
+
+  fiber->resumer = vm;
+  fvm->flag_preemption = 0;
+  int ret = mrbc_vm_run( fvm );
+  fiber->resumer = NULL;
+
+  mrbc_value val;
+  switch( ret ) {
+  case 0:	// Fiber.yield
+    val = fiber->ret;
+    fiber->ret = mrbc_nil_value();
+    break;
+
+  case 1:	// the block has finished.
+    val = fvm->regs[0];
+    fvm->regs[0].tt = MRBC_TT_EMPTY;
+    fiber_terminate( fiber );
+    break;
+
+  default:	// raise the exception in the resumer.
+    vm->exception = fvm->exception;
+    vm->flag_preemption = 2;
+    fvm->exception = mrbc_nil_value();
+    fiber_terminate( fiber );
+    return;
+  }
+
+  SET_RETURN(val);
+}
+
+
+//================================================================
+/*! (method) alive?
+*/
+static void c_fiber_alive(struct VM *vm, mrbc_value v[], int argc)
+{
+  SET_BOOL_RETURN( !fiber_of(&v[0])->vm.flag_stop );
+}
+
+
+//================================================================
+/*! (class method) yield
+*/
+static void c_fiber_yield(struct VM *vm, mrbc_value v[], int argc)
+{
+  if( !vm->flag_fiber ) {
+    mrbc_raise(vm, MRBC_CLASS(RuntimeError), "can't yield from root fiber");
+    return;
+  }
+
+  mrbc_fiber *fiber = MRBC_VM2FIBER(vm);
+  mrbc_decref( &fiber->ret );
+  fiber->ret = fiber_args( vm, v, argc );
+  fiber->yield_ret = &v[0];
+
+  // return from mrbc_vm_run() in resume.
+  vm->flag_preemption = 1;
+}
+
+
+/* MRBC_AUTOGEN_METHOD_TABLE
+
+  CLASS("Fiber")
+  FILE("_autogen_class_fiber.h")
+
+  METHOD( "new",	c_fiber_new )
+  METHOD( "resume",	c_fiber_resume )
+  METHOD( "alive?",	c_fiber_alive )
+  METHOD( "yield",	c_fiber_yield )
+*/
+#include "_autogen_class_fiber.h"
@@ -0,0 +1,70 @@
+/*! @file
+  @brief
+  mruby/c Fiber class
+
+  <pre>
+  Copyright (C) 2015-2022 Kyushu Institute of Technology.
+  Copyright (C) 2015-2022 Shimane IT Open-Innovation Center.
+
+  This file is distributed under BSD 3-Clause License.
+
+  </pre>
+*/
+
+#ifndef MRBC_SRC_C_FIBER_H_
+#define MRBC_SRC_C_FIBER_H_
+
+/***** Feature test switches ************************************************/
+/***** System headers *******************************************************/
+//@cond
+#include <stddef.h>
+#include <stdint.h>
+//@endcond
+
+/***** Local headers ********************************************************/
+#include "value.h"
+#include "vm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***** Constat values *******************************************************/
+/***** Macros ***************************************************************/
+//! get the Fiber that owns the VM. (vm->flag_fiber must be set)
+#define MRBC_VM2FIBER(vm) \
+  ((mrbc_fiber *)((uint8_t *)(vm) - offsetof(mrbc_fiber, vm)))
+
+
+/***** Typedefs *************************************************************/
+//================================================================
+/*!@brief
+  Fiber
+
+  A Fiber is a VM of its own, that shares the classes, globals and the
+  top level of the VM that created it. Its register and CALLINFO stacks
+  are smaller than those of a task. (mrbc_vm_stack)
+*/
+typedef struct RFiber {
+  struct VM *resumer;		//!< VM that resumed this, while running.
+  mrbc_value *yield_ret;	//!< return value of the waiting Fiber.yield
+  mrbc_value ret;		//!< value passed by Fiber.yield
+
+  struct VM vm;
+  mrbc_value regs[MAX_FIBER_REGS_SIZE];		 //!< registers of vm.
+  mrbc_callinfo callinfo[MAX_FIBER_CALLINFO_COUNT]; //!< CALLINFO stack of vm.
+} mrbc_fiber;
+
+
+/***** Global variables *****************************************************/
+/***** Function prototypes **************************************************/
+void mrbc_fiber_delete(mrbc_value *v);
+
+
+/***** Inline functions *****************************************************/
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif
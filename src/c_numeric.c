@@ -345,7 +345,7 @@ static void c_float_to_s(struct VM *vm, mrbc_value v[], int argc)
 {
   char buf[16];
 
-  snprintf( buf, sizeof(buf), "%g", v->d );
+  mrbc_snprintf( buf, sizeof(buf), "%g", v->d );
   mrbc_value value = mrbc_string_new_cstr(vm, buf);
   SET_RETURN(value);
 }
@@ -58,6 +58,7 @@ static void c_object_new(struct VM *vm, mrbc_value v[], int argc)
   mrbc_set_nil(&v[argc+1]);
   mrbc_callinfo *callinfo = mrbc_push_callinfo(vm, MRBC_SYM(initialize),
 					       (v - vm->cur_regs), argc);
+  if( !callinfo ) return;
   callinfo->own_class = method.cls;
 
   vm->cur_irep = method.irep;
@@ -130,7 +131,8 @@ static void c_object_dup(struct VM *vm, mrbc_value v[], int argc)
 {
   if( mrbc_type(v[0]) == MRBC_TT_OBJECT ) {
     mrbc_value new_obj = mrbc_instance_new(vm, v->instance->cls, 0);
-    mrbc_kv_dup( &v->instance->ivar, &new_obj.instance->ivar );
+    if( !new_obj.instance ) return;	// ENOMEM
+    mrbc_instance_dup_ivar( v, &new_obj );
 
     mrbc_decref( v );
     *v = new_obj;
@@ -273,7 +275,7 @@ static void c_object_raise(struct VM *vm, mrbc_value v[], int argc)
   // case 2. raise "message"
   if( argc == 1 && mrbc_type(v[1]) == MRBC_TT_STRING ) {
     vm->exception = mrbc_exception_new( vm, MRBC_CLASS(RuntimeError),
-			mrbc_string_cstr(&v[1]), mrbc_string_size(&v[1]) );
+			mrbc_string_ptr(&v[1]), mrbc_string_size(&v[1]) );
   } else
 
   // case 3. raise ExceptionClass
@@ -292,14 +294,14 @@ static void c_object_raise(struct VM *vm, mrbc_value v[], int argc)
   if( argc == 2 && mrbc_type(v[1]) == MRBC_TT_CLASS
                 && mrbc_type(v[2]) == MRBC_TT_STRING ) {
     vm->exception = mrbc_exception_new( vm, v[1].cls,
-			mrbc_string_cstr(&v[2]), mrbc_string_size(&v[2]) );
+			mrbc_string_ptr(&v[2]), mrbc_string_size(&v[2]) );
   } else
 
   // case 6. raise ExceptionObject, "param"
   if( argc == 2 && mrbc_type(v[1]) == MRBC_TT_EXCEPTION
                 && mrbc_type(v[2]) == MRBC_TT_STRING ) {
     vm->exception = mrbc_exception_new( vm, v[1].exception->cls,
-			mrbc_string_cstr(&v[2]), mrbc_string_size(&v[2]) );
+			mrbc_string_ptr(&v[2]), mrbc_string_size(&v[2]) );
   } else {
 
     // fail.
@@ -354,15 +356,15 @@ static void c_object_instance_variables(struct VM *vm, mrbc_value v[], int argc)
 {
   // temporary code for operation check.
 #if 1
-  mrbc_kv_handle *kvh = &v[0].instance->ivar;
+  const mrbc_instance *inst = v[0].instance;
 
-  mrbc_printf("n = %d/%d ", kvh->n_stored, kvh->data_size);
+  mrbc_printf("n = %d/%d ", inst->shape->n_ivars, inst->ivar_capa);
   mrbc_printf("[");
 
   int i;
-  for( i = 0; i < kvh->n_stored; i++ ) {
+  for( i = 0; i < inst->shape->n_ivars; i++ ) {
     mrbc_printf("%s:@%s", (i == 0 ? "" : ", "),
-		mrbc_symid_to_str( kvh->data[i].sym_id ));
+		mrbc_symid_to_str( mrbc_shape_symbol( inst->shape, i )));
   }
 
   mrbc_printf("]\n");
@@ -407,12 +409,27 @@ static void c_object_memory_statistics(struct VM *vm, mrbc_value v[], int argc)
 #endif  // MRBC_DEBUG
 
 
+//================================================================
+/*! get the ivar symbol ID of the called accessor method.
+ */
+static mrbc_sym get_accessor_ivar_id(struct VM *vm, mrbc_value v[])
+{
+  mrbc_method method;
+  if( mrbc_find_method( &method, find_class_by_object(&v[0]),
+			mrbc_get_callee_symid(vm) ) == 0 ) return -1;
+
+  return method.ivar_id;
+}
+
+
 //================================================================
 /*! (method) instance variable getter used by attr_reader.
+
+  @note	usually, the VM executes this inline. (see send_by_name)
  */
 static void c_object_getiv(struct VM *vm, mrbc_value v[], int argc)
 {
-  mrbc_sym sym_id = mrbc_get_callee_symid(vm);
+  mrbc_sym sym_id = get_accessor_ivar_id(vm, v);
   mrbc_value ret = mrbc_instance_getiv(&v[0], sym_id);
 
   SET_RETURN(ret);
@@ -421,20 +438,15 @@ static void c_object_getiv(struct VM *vm, mrbc_value v[], int argc)
 
 //================================================================
 /*! (method) instance variable setter used by attr_accessor.
+
+  @note	usually, the VM executes this inline. (see send_by_name)
  */
 static void c_object_setiv(struct VM *vm, mrbc_value v[], int argc)
 {
-  const char *name = mrbc_get_callee_name(vm);
-  int len = strlen(name);
-  char *namebuf = mrbc_alloc(vm, len);
-  if( !namebuf ) return;
-
-  memcpy( namebuf, name, len-1 );
-  namebuf[len-1] = '\0';	// delete '='
-  mrbc_sym sym_id = mrbc_str_to_symid(namebuf);
+  mrbc_sym sym_id = get_accessor_ivar_id(vm, v);
+  if( sym_id < 0 ) return;
 
   mrbc_instance_setiv(&v[0], sym_id, &v[1]);
-  mrbc_free(vm, namebuf);
 }
 
 
@@ -453,7 +465,7 @@ static void c_object_attr_reader(struct VM *vm, mrbc_value v[], int argc)
 
     // define reader method
     const char *name = mrbc_symbol_cstr(&v[i]);
-    mrbc_define_method(vm, v[0].cls, name, c_object_getiv);
+    mrbc_define_accessor(vm, v[0].cls, name, c_object_getiv, 3, v[i].i);
   }
 }
 
@@ -473,7 +485,7 @@ static void c_object_attr_accessor(struct VM *vm, mrbc_value v[], int argc)
 
     // define reader method
     const char *name = mrbc_symbol_cstr(&v[i]);
-    mrbc_define_method(vm, v[0].cls, name, c_object_getiv);
+    mrbc_define_accessor(vm, v[0].cls, name, c_object_getiv, 3, v[i].i);
 
     // make string "....=" and define writer method.
     int len = strlen(name);
@@ -483,7 +495,7 @@ static void c_object_attr_accessor(struct VM *vm, mrbc_value v[], int argc)
     namebuf[len] = '=';
     namebuf[len+1] = 0;
     mrbc_symbol_new(vm, namebuf);
-    mrbc_define_method(vm, v[0].cls, namebuf, c_object_setiv);
+    mrbc_define_accessor(vm, v[0].cls, namebuf, c_object_setiv, 4, v[i].i);
     mrbc_free(vm, namebuf);
   }
 }
@@ -507,8 +519,16 @@ static void c_object_sprintf(struct VM *vm, mrbc_value v[], int argc)
   char *buf = mrbc_alloc(vm, buflen);
   if( !buf ) { return; }	// ENOMEM raise?
 
+  char fbuf[64];
+  const char *fstr = mrbc_string_cstr_buf(format, fbuf, sizeof(fbuf));
+  if( !fstr ) {
+    mrbc_free(vm, buf);
+    mrbc_raise(vm, MRBC_CLASS(NoMemoryError), 0);
+    return;
+  }
+
   mrbc_printf_t pf;
-  mrbc_printf_init( &pf, buf, buflen, mrbc_string_cstr(format) );
+  mrbc_printf_init( &pf, buf, buflen, fstr );
 
   int i = 2;
   int ret;
@@ -529,13 +549,13 @@ static void c_object_sprintf(struct VM *vm, mrbc_value v[], int argc)
       if( mrbc_type(v[i]) == MRBC_TT_INTEGER ) {
 	ret = mrbc_printf_char( &pf, v[i].i );
       } else if( mrbc_type(v[i]) == MRBC_TT_STRING ) {
-	ret = mrbc_printf_char( &pf, mrbc_string_cstr(&v[i])[0] );
+	ret = mrbc_printf_char( &pf, mrbc_string_ptr(&v[i])[0] );
       }
       break;
 
     case 's':
       if( mrbc_type(v[i]) == MRBC_TT_STRING ) {
-	ret = mrbc_printf_bstr( &pf, mrbc_string_cstr(&v[i]), mrbc_string_size(&v[i]),' ');
+	ret = mrbc_printf_bstr( &pf, mrbc_string_ptr(&v[i]), mrbc_string_size(&v[i]),' ');
       } else if( mrbc_type(v[i]) == MRBC_TT_SYMBOL ) {
 	ret = mrbc_printf_str( &pf, mrbc_symbol_cstr( &v[i] ), ' ');
       }
@@ -551,7 +571,8 @@ static void c_object_sprintf(struct VM *vm, mrbc_value v[], int argc)
 	ret = mrbc_printf_int( &pf, (mrbc_int)v[i].d, 10);
 #endif
       } else if( mrbc_type(v[i]) == MRBC_TT_STRING ) {
-	mrbc_int ival = atol(mrbc_string_cstr(&v[i]));
+	mrbc_int ival = mrbc_atoi_n(mrbc_string_ptr(&v[i]),
+				    mrbc_string_size(&v[i]), 10);
 	ret = mrbc_printf_int( &pf, ival, 10 );
       }
       break;
@@ -625,7 +646,7 @@ static void c_object_sprintf(struct VM *vm, mrbc_value v[], int argc)
 static void c_object_printf(struct VM *vm, mrbc_value v[], int argc)
 {
   c_object_sprintf(vm, v, argc);
-  mrbc_nprint( mrbc_string_cstr(v), mrbc_string_size(v) );
+  mrbc_nprint( mrbc_string_ptr(v), mrbc_string_size(v) );
   SET_NIL_RETURN();
 }
 
@@ -16,7 +16,9 @@
 //@cond
 #include "vm_config.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include <types.h>
+#include <tools.h>
 #include <string.h>
 #include <limits.h>
 #include <assert.h>
@@ -61,6 +63,60 @@ static int is_space( int ch )
 }
 
 
+//================================================================
+/*! release the parent string of the view.
+
+  @param  h	pointer to RString. (MRBC_STRING_VIEW)
+*/
+static void string_release_parent( mrbc_string *h )
+{
+  mrbc_value parent = {.tt = MRBC_TT_STRING};
+  parent.string = h->parent;
+  mrbc_decref( &parent );
+}
+
+
+//================================================================
+/*! resize the string buffer.
+
+  Inline, static or view buffer is moved to the heap if needed.
+
+  @param  h	pointer to RString.
+  @param  size	new buffer size. (including '\0')
+  @return	pointer to buffer or NULL (ENOMEM).
+*/
+static uint8_t * string_resize_buffer( mrbc_string *h, int size )
+{
+  uint8_t *buf;
+
+  if( h->storage == MRBC_STRING_HEAP ) {
+    buf = mrbc_raw_realloc( h->data, size );
+    if( buf ) h->data = buf;
+    return buf;
+  }
+
+  // shrink inline buffer, nothing to do.
+  if( h->storage == MRBC_STRING_INLINE && size <= h->size + 1 ) return h->data;
+
+  buf = mrbc_raw_alloc( size );
+  if( !buf ) return NULL;		// ENOMEM
+  mrbc_set_vm_id( buf, mrbc_get_vm_id(h) );
+
+  // static and view data may not be terminated by '\0'.
+  if( size > h->size ) {
+    memcpy( buf, h->data, h->size );
+    buf[h->size] = '\0';
+  } else {
+    memcpy( buf, h->data, size );
+  }
+  if( h->storage == MRBC_STRING_VIEW ) string_release_parent( h );
+  h->data = buf;
+  h->storage = MRBC_STRING_HEAP;
+
+  return buf;
+}
+
+
 /***** Global functions *****************************************************/
 //================================================================
 /*! constructor
@@ -73,21 +129,35 @@ static int is_space( int ch )
 mrbc_value mrbc_string_new(struct VM *vm, const void *src, int len)
 {
   mrbc_value value = {.tt = MRBC_TT_STRING};
+  mrbc_string *h;
+  uint8_t *str;
 
   /*
     Allocate handle and string buffer.
   */
-  mrbc_string *h = mrbc_alloc(vm, sizeof(mrbc_string));
-  if( !h ) {
-    KLog("out of memory for h"); KLog((char*)src);
-    return value;		// ENOMEM
-  }
+  if( len < MRBC_STRING_INLINE_SIZE ) {
+    h = mrbc_alloc(vm, offsetof(mrbc_string, buf) + len + 1);
+    if( !h ) {
+      KLog("out of memory for h"); KLog((char*)src);
+      return value;		// ENOMEM
+    }
+    h->storage = MRBC_STRING_INLINE;
+    str = h->buf;
+
+  } else {
+    h = mrbc_alloc(vm, sizeof(mrbc_string));
+    if( !h ) {
+      KLog("out of memory for h"); KLog((char*)src);
+      return value;		// ENOMEM
+    }
 
-  uint8_t *str = mrbc_alloc(vm, len+1);
-  if( !str ) {				// ENOMEM
-    KLog("out of memory for str"); KLog((char*)src);
-    mrbc_raw_free( h );
-    return value;
+    str = mrbc_alloc(vm, len+1);
+    if( !str ) {				// ENOMEM
+      KLog("out of memory for str"); KLog((char*)src);
+      mrbc_raw_free( h );
+      return value;
+    }
+    h->storage = MRBC_STRING_HEAP;
   }
 
   MRBC_INIT_OBJECT_HEADER( h, "ST" );
@@ -142,6 +212,7 @@ mrbc_value mrbc_string_new_alloc(struct VM *vm, void *buf, int len)
 
   MRBC_INIT_OBJECT_HEADER( h, "ST" );
   h->size = len;
+  h->storage = MRBC_STRING_HEAP;
   h->data = buf;
 
   value.string = h;
@@ -149,6 +220,120 @@ mrbc_value mrbc_string_new_alloc(struct VM *vm, void *buf, int len)
 }
 
 
+//================================================================
+/*! constructor by read-only buffer (e.g. string literal in IREP pool)
+
+  The buffer is not copied until the string is modified.
+
+  @param  vm	pointer to VM.
+  @param  buf	pointer to read-only buffer. must be terminated by '\0'.
+  @param  len	length
+  @return 	string object
+*/
+mrbc_value mrbc_string_new_static(struct VM *vm, const void *buf, int len)
+{
+  mrbc_value value = mrbc_string_new_alloc(vm, (void *)buf, len);
+  if( value.string ) value.string->storage = MRBC_STRING_STATIC;
+
+  return value;
+}
+
+
+//================================================================
+/*! constructor of substring view (src[ofs, len])
+
+  The bytes are shared with the source string until either is modified.
+  A heap buffer is handed over to a hidden parent string which is
+  referred by both the source and the view. Short substrings are copied.
+
+  @param  vm	pointer to VM.
+  @param  src	pointer to source string.
+  @param  ofs	offset in the source string.
+  @param  len	length
+  @return 	string object
+*/
+mrbc_value mrbc_string_new_view(struct VM *vm, mrbc_value *src, int ofs, int len)
+{
+  mrbc_string *h = src->string;
+  uint8_t *data = h->data + ofs;
+
+  switch( h->storage ) {
+  case MRBC_STRING_STATIC:
+    return mrbc_string_new_static(vm, data, len);
+
+  case MRBC_STRING_VIEW:
+    break;
+
+  case MRBC_STRING_HEAP:
+    if( len >= MRBC_STRING_INLINE_SIZE ) {
+      // hand over the buffer to the hidden parent, and src becomes a view.
+      mrbc_value parent = mrbc_string_new_alloc(vm, h->data, h->size);
+      if( parent.string == NULL ) return parent;	// ENOMEM
+      h->storage = MRBC_STRING_VIEW;
+      h->parent = parent.string;
+      break;
+    }
+    // fall through
+  default:
+    return mrbc_string_new(vm, data, len);
+  }
+
+  mrbc_value value = {.tt = MRBC_TT_STRING};
+  mrbc_string *view = mrbc_alloc(vm, sizeof(mrbc_string));
+  if( !view ) return value;		// ENOMEM
+
+  MRBC_INIT_OBJECT_HEADER( view, "ST" );
+  view->size = len;
+  view->storage = MRBC_STRING_VIEW;
+  view->data = data;
+  view->parent = h->parent;
+  view->parent->ref_count++;
+
+  value.string = view;
+  return value;
+}
+
+
+//================================================================
+/*! copy the read-only or shared buffer to own allocated buffer.
+
+  @param  str	pointer to target value
+  @return	mrbc_error_code
+*/
+int mrbc_string_detach(mrbc_value *str)
+{
+  mrbc_string *h = str->string;
+  if( h->storage != MRBC_STRING_STATIC &&
+      h->storage != MRBC_STRING_VIEW ) return 0;
+
+  if( !string_resize_buffer( h, h->size + 1 ) ) return E_NOMEMORY_ERROR;
+
+  return 0;
+}
+
+
+//================================================================
+/*! get c-language string for reading, without copying to own buffer.
+
+  @param  v		pointer to target value
+  @param  buf		buffer for a substring not terminated by '\0'.
+  @param  bufsize	size of buf.
+  @return		pointer to c-language string, or NULL if ENOMEM.
+  @note	a substring that does not fit in buf is copied as mrbc_string_cstr().
+*/
+const char * mrbc_string_cstr_buf(mrbc_value *v, char *buf, int bufsize)
+{
+  mrbc_string *h = v->string;
+  if( (h->storage != MRBC_STRING_STATIC && h->storage != MRBC_STRING_VIEW) ||
+      h->data[h->size] == '\0' ) return (const char*)h->data;
+  if( h->size >= bufsize ) return mrbc_string_cstr(v);
+
+  memcpy( buf, h->data, h->size );
+  buf[h->size] = '\0';
+  return buf;
+}
+
+
 //================================================================
 /*! destructor
 
@@ -156,7 +341,11 @@ mrbc_value mrbc_string_new_alloc(struct VM *vm, void *buf, int len)
 */
 void mrbc_string_delete(mrbc_value *str)
 {
-  mrbc_raw_free(str->string->data);
+  if( str->string->storage == MRBC_STRING_HEAP ) {
+    mrbc_raw_free(str->string->data);
+  } else if( str->string->storage == MRBC_STRING_VIEW ) {
+    string_release_parent(str->string);
+  }
   mrbc_raw_free(str->string);
 }
 
@@ -167,8 +356,16 @@ void mrbc_string_delete(mrbc_value *str)
 */
 void mrbc_string_clear(mrbc_value *str)
 {
-  mrbc_raw_realloc(str->string->data, 1);
-  str->string->data[0] = '\0';
+  if( str->string->storage == MRBC_STRING_VIEW ) {
+    string_release_parent(str->string);
+    str->string->storage = MRBC_STRING_STATIC;
+  }
+  if( str->string->storage == MRBC_STRING_STATIC ) {
+    str->string->data = (uint8_t *)"";
+  } else {
+    string_resize_buffer(str->string, 1);
+    str->string->data[0] = '\0';
+  }
   str->string->size = 0;
 }
 
@@ -179,8 +376,13 @@ void mrbc_string_clear(mrbc_value *str)
 */
 void mrbc_string_clear_vm_id(mrbc_value *str)
 {
+  // the read-only buffer or the parent may be released along with the VM.
+  mrbc_string_detach( str );
+
   mrbc_set_vm_id( str->string, 0 );
-  mrbc_set_vm_id( str->string->data, 0 );
+  if( str->string->storage == MRBC_STRING_HEAP ) {
+    mrbc_set_vm_id( str->string->data, 0 );
+  }
 }
 #endif
 
@@ -199,7 +401,8 @@ mrbc_value mrbc_string_dup(struct VM *vm, mrbc_value *s1)
   mrbc_value value = mrbc_string_new(vm, NULL, h1->size);
   if( value.string == NULL ) return value;		// ENOMEM
 
-  memcpy( value.string->data, h1->data, h1->size + 1 );
+  memcpy( value.string->data, h1->data, h1->size );
+  value.string->data[h1->size] = '\0';
 
   return value;
 }
@@ -222,7 +425,8 @@ mrbc_value mrbc_string_add(struct VM *vm, const mrbc_value *s1, const mrbc_value
   if( value.string == NULL ) return value;		// ENOMEM
 
   memcpy( value.string->data,            h1->data, h1->size );
-  memcpy( value.string->data + h1->size, h2->data, h2->size + 1 );
+  memcpy( value.string->data + h1->size, h2->data, h2->size );
+  value.string->data[h1->size + h2->size] = '\0';
 
   return value;
 }
@@ -240,11 +444,12 @@ int mrbc_string_append(mrbc_value *s1, const mrbc_value *s2)
   int len1 = s1->string->size;
   int len2 = (mrbc_type(*s2) == MRBC_TT_STRING) ? s2->string->size : 1;
 
-  uint8_t *str = mrbc_raw_realloc(s1->string->data, len1+len2+1);
+  uint8_t *str = string_resize_buffer(s1->string, len1+len2+1);
   if( !str ) return E_NOMEMORY_ERROR;
 
   if( mrbc_type(*s2) == MRBC_TT_STRING ) {
-    memcpy(str + len1, s2->string->data, len2 + 1);
+    memcpy(str + len1, s2->string->data, len2);
+    str[len1+len2] = '\0';
   } else if( mrbc_type(*s2) == MRBC_TT_INTEGER ) {
     str[len1] = s2->i;
     str[len1+1] = '\0';
@@ -269,7 +474,7 @@ int mrbc_string_append_cstr(mrbc_value *s1, const char *s2)
   int len1 = s1->string->size;
   int len2 = strlen(s2);
 
-  uint8_t *str = mrbc_raw_realloc(s1->string->data, len1+len2+1);
+  uint8_t *str = string_resize_buffer(s1->string, len1+len2+1);
   if( !str ) return E_NOMEMORY_ERROR;
 
   memcpy(str + len1, s2, len2 + 1);
@@ -291,13 +496,13 @@ int mrbc_string_append_cstr(mrbc_value *s1, const char *s2)
 */
 int mrbc_string_index(const mrbc_value *src, const mrbc_value *pattern, int offset)
 {
-  char *p1 = mrbc_string_cstr(src) + offset;
-  char *p2 = mrbc_string_cstr(pattern);
+  char *p1 = mrbc_string_ptr(src) + offset;
+  char *p2 = mrbc_string_ptr(pattern);
   int try_cnt = mrbc_string_size(src) - mrbc_string_size(pattern) - offset;
 
   while( try_cnt >= 0 ) {
     if( memcmp( p1, p2, mrbc_string_size(pattern) ) == 0 ) {
-      return p1 - mrbc_string_cstr(src);	// matched.
+      return p1 - mrbc_string_ptr(src);	// matched.
     }
     try_cnt--;
     p1++;
@@ -316,7 +521,7 @@ int mrbc_string_index(const mrbc_value *src, const mrbc_value *pattern, int offs
 */
 int mrbc_string_strip(mrbc_value *src, int mode)
 {
-  char *p1 = mrbc_string_cstr(src);
+  char *p1 = mrbc_string_ptr(src);
   char *p2 = p1 + mrbc_string_size(src) - 1;
 
   // left-side
@@ -338,10 +543,13 @@ int mrbc_string_strip(mrbc_value *src, int mode)
   int new_size = p2 - p1 + 1;
   if( mrbc_string_size(src) == new_size ) return 0;
 
-  char *buf = mrbc_string_cstr(src);
-  if( p1 != buf ) memmove( buf, p1, new_size );
+  int ofs = p1 - mrbc_string_ptr(src);
+  if( mrbc_string_modifiable(src) != 0 ) return 0;	// ENOMEM
+
+  char *buf = mrbc_string_ptr(src);
+  if( ofs != 0 ) memmove( buf, buf + ofs, new_size );
   buf[new_size] = '\0';
-  mrbc_raw_realloc(buf, new_size+1);	// shrink suitable size.
+  string_resize_buffer(src->string, new_size+1);	// shrink suitable size.
   src->string->size = new_size;
 
   return 1;
@@ -356,7 +564,7 @@ int mrbc_string_strip(mrbc_value *src, int mode)
 */
 int mrbc_string_chomp(mrbc_value *src)
 {
-  char *p1 = mrbc_string_cstr(src);
+  char *p1 = mrbc_string_ptr(src);
   char *p2 = p1 + mrbc_string_size(src) - 1;
 
   if( *p2 == '\n' ) {
@@ -368,8 +576,9 @@ int mrbc_string_chomp(mrbc_value *src)
 
   int new_size = p2 - p1 + 1;
   if( mrbc_string_size(src) == new_size ) return 0;
+  if( mrbc_string_modifiable(src) != 0 ) return 0;	// ENOMEM
 
-  char *buf = mrbc_string_cstr(src);
+  char *buf = mrbc_string_ptr(src);
   buf[new_size] = '\0';
   src->string->size = new_size;
 
@@ -439,7 +648,7 @@ static void c_string_mul(struct VM *vm, mrbc_value v[], int argc)
   uint8_t *p = value.string->data;
   int i;
   for( i = 0; i < v[1].i; i++ ) {
-    memcpy( p, mrbc_string_cstr(&v[0]), mrbc_string_size(&v[0]) );
+    memcpy( p, mrbc_string_ptr(&v[0]), mrbc_string_size(&v[0]) );
     p += mrbc_string_size(&v[0]);
   }
   *p = 0;
@@ -475,7 +684,7 @@ static void c_string_to_i(struct VM *vm, mrbc_value v[], int argc)
     }
   }
 
-  mrbc_int i = mrbc_atoi( mrbc_string_cstr(v), base );
+  mrbc_int i = mrbc_atoi_n( mrbc_string_ptr(v), mrbc_string_size(v), base );
 
   SET_INT_RETURN( i );
 }
@@ -487,7 +696,13 @@ static void c_string_to_i(struct VM *vm, mrbc_value v[], int argc)
 */
 static void c_string_to_f(struct VM *vm, mrbc_value v[], int argc)
 {
-  mrbc_float d = atof(mrbc_string_cstr(v));
+  char buf[32];
+  const char *s = mrbc_string_cstr_buf(v, buf, sizeof(buf));
+  if( !s ) {
+    mrbc_raise(vm, MRBC_CLASS(NoMemoryError), 0);
+    return;
+  }
+  mrbc_float d = atof(s);
 
   SET_FLOAT_RETURN( d );
 }
@@ -535,7 +750,7 @@ static void c_string_slice(struct VM *vm, mrbc_value v[], int argc)
   if( len < 0 ) goto RETURN_NIL;
   if( argc == 1 && len <= 0 ) goto RETURN_NIL;
 
-  mrbc_value ret = mrbc_string_new(vm, mrbc_string_cstr(v) + pos, len);
+  mrbc_value ret = mrbc_string_new_view(vm, v, pos, len);
   if( !ret.string ) goto RETURN_NIL;		// ENOMEM
 
   SET_RETURN(ret);
@@ -591,11 +806,12 @@ static void c_string_insert(struct VM *vm, mrbc_value v[], int argc)
     return;
   }
 
-  uint8_t *str = mrbc_realloc(vm, mrbc_string_cstr(v), len1 + len2 - len + 1);
+  if( mrbc_string_modifiable(v) != 0 ) return;	// ENOMEM
+  uint8_t *str = string_resize_buffer(v->string, len1 + len2 - len + 1);
   if( !str ) return;
 
   memmove( str + nth + len2, str + nth + len, len1 - nth - len + 1 );
-  memcpy( str + nth, mrbc_string_cstr(val), len2 );
+  memcpy( str + nth, mrbc_string_ptr(val), len2 );
   v->string->size = len1 + len2 - len;
 
   v->string->data = str;
@@ -669,7 +885,7 @@ static void c_string_getbyte(struct VM *vm, mrbc_value v[], int argc)
     idx += len;
   }
   if( idx >= 0 ) {
-    SET_INT_RETURN( ((uint8_t *)mrbc_string_cstr(&v[0]))[idx] );
+    SET_INT_RETURN( ((uint8_t *)mrbc_string_ptr(&v[0]))[idx] );
   } else {
     SET_NIL_RETURN();
   }
@@ -715,7 +931,7 @@ static void c_string_inspect(struct VM *vm, mrbc_value v[], int argc)
 {
   char buf[10] = "\\x";
   mrbc_value ret = mrbc_string_new_cstr(vm, "\"");
-  const unsigned char *s = (const unsigned char *)mrbc_string_cstr(v);
+  const unsigned char *s = (const unsigned char *)mrbc_string_ptr(v);
   int i;
   for( i = 0; i < mrbc_string_size(v); i++ ) {
     if( s[i] < ' ' || 0x7f <= s[i] ) {	// tiny isprint()
@@ -738,7 +954,7 @@ static void c_string_inspect(struct VM *vm, mrbc_value v[], int argc)
 */
 static void c_string_ord(struct VM *vm, mrbc_value v[], int argc)
 {
-  int i = ((uint8_t *)mrbc_string_cstr(v))[0];
+  int i = ((uint8_t *)mrbc_string_ptr(v))[0];
 
   SET_INT_RETURN( i );
 }
@@ -774,14 +990,18 @@ static void c_string_slice_self(struct VM *vm, mrbc_value v[], int argc)
   if( len < 0 ) goto RETURN_NIL;
   if( argc == 1 && len <= 0 ) goto RETURN_NIL;
 
-  mrbc_value ret = mrbc_string_new(vm, mrbc_string_cstr(v) + pos, len);
+  mrbc_value ret = mrbc_string_new(vm, mrbc_string_ptr(v) + pos, len);
   if( !ret.string ) goto RETURN_NIL;		// ENOMEM
 
   if( len > 0 ) {
-    memmove( mrbc_string_cstr(v) + pos, mrbc_string_cstr(v) + pos + len,
+    if( mrbc_string_modifiable(v) != 0 ) {	// ENOMEM
+      mrbc_decref( &ret );
+      goto RETURN_NIL;
+    }
+    memmove( mrbc_string_ptr(v) + pos, mrbc_string_ptr(v) + pos + len,
 	     mrbc_string_size(v) - pos - len + 1 );
     v->string->size = mrbc_string_size(v) - len;
-    mrbc_raw_realloc( mrbc_string_cstr(v), mrbc_string_size(v)+1 );
+    string_resize_buffer( v->string, mrbc_string_size(v)+1 );
   }
 
   SET_RETURN(ret);
@@ -830,7 +1050,7 @@ static void c_string_split(struct VM *vm, mrbc_value v[], int argc)
     return;
   }
 
-  int flag_strip = (mrbc_string_cstr(&sep)[0] == ' ') &&
+  int flag_strip = (mrbc_string_ptr(&sep)[0] == ' ') &&
 		   (mrbc_string_size(&sep) == 1);
   int offset = 0;
   int sep_len = mrbc_string_size(&sep);
@@ -841,7 +1061,7 @@ static void c_string_split(struct VM *vm, mrbc_value v[], int argc)
 
     if( flag_strip ) {
       for( ; offset < mrbc_string_size(&v[0]); offset++ ) {
-	if( !is_space( mrbc_string_cstr(&v[0])[offset] )) break;
+	if( !is_space( mrbc_string_ptr(&v[0])[offset] )) break;
       }
       if( offset > mrbc_string_size(&v[0])) break;
     }
@@ -856,7 +1076,7 @@ static void c_string_split(struct VM *vm, mrbc_value v[], int argc)
     if( flag_strip ) {
       pos = offset;
       for( ; pos < mrbc_string_size(&v[0]); pos++ ) {
-	if( is_space( mrbc_string_cstr(&v[0])[pos] )) break;
+	if( is_space( mrbc_string_ptr(&v[0])[pos] )) break;
       }
       len = pos - offset;
       goto SPLIT_ITEM;
@@ -877,7 +1097,7 @@ static void c_string_split(struct VM *vm, mrbc_value v[], int argc)
   SPLIT_ITEM:
     if( pos < 0 ) len = mrbc_string_size(&v[0]) - offset;
 
-    mrbc_value v1 = mrbc_string_new(vm, mrbc_string_cstr(&v[0]) + offset, len);
+    mrbc_value v1 = mrbc_string_new_view(vm, &v[0], offset, len);
     mrbc_array_push( &ret, &v1 );
 
     if( pos < 0 ) break;
@@ -984,7 +1204,8 @@ static void c_string_strip_self(struct VM *vm, mrbc_value v[], int argc)
 */
 static void c_string_to_sym(struct VM *vm, mrbc_value v[], int argc)
 {
-  mrbc_value ret = mrbc_symbol_new(vm, mrbc_string_cstr(&v[0]));
+  mrbc_value ret = mrbc_symbol_new_n(vm, mrbc_string_ptr(&v[0]),
+				     mrbc_string_size(&v[0]));
 
   SET_RETURN(ret);
 }
@@ -1019,7 +1240,7 @@ static void tr_free_pattern( struct tr_pattern *pat )
 
 static struct tr_pattern * tr_parse_pattern( struct VM *vm, const mrbc_value *v_pattern, int flag_reverse_enable )
 {
-  const char *pattern = mrbc_string_cstr( v_pattern );
+  const char *pattern = mrbc_string_ptr( v_pattern );
   int pattern_length = mrbc_string_size( v_pattern );
   int flag_reverse = 0;
   struct tr_pattern *ret = NULL;
@@ -1128,13 +1349,15 @@ static int tr_main( struct VM *vm, mrbc_value v[], int argc )
     return -1;
   }
 
+  if( mrbc_string_modifiable( &v[0] ) != 0 ) return 0;	// ENOMEM
+
   struct tr_pattern *pat = tr_parse_pattern( vm, &v[1], 1 );
   if( pat == NULL ) return 0;
 
   struct tr_pattern *rep = tr_parse_pattern( vm, &v[2], 0 );
 
   int flag_changed = 0;
-  char *s = mrbc_string_cstr( &v[0] );
+  char *s = mrbc_string_ptr( &v[0] );
   int len = mrbc_string_size( &v[0] );
   int i;
   for( i = 0; i < len; i++ ) {
@@ -1195,7 +1418,7 @@ static void c_string_start_with(struct VM *vm, mrbc_value v[], int argc)
   if( mrbc_string_size(&v[0]) < mrbc_string_size(&v[1]) ) {
     ret = 0;
   } else {
-    ret = (memcmp( mrbc_string_cstr(&v[0]), mrbc_string_cstr(&v[1]),
+    ret = (memcmp( mrbc_string_ptr(&v[0]), mrbc_string_ptr(&v[1]),
 		   mrbc_string_size(&v[1]) ) == 0);
   }
 
@@ -1218,7 +1441,7 @@ static void c_string_end_with(struct VM *vm, mrbc_value v[], int argc)
   if( offset < 0 ) {
     ret = 0;
   } else {
-    ret = (memcmp( mrbc_string_cstr(&v[0]) + offset, mrbc_string_cstr(&v[1]),
+    ret = (memcmp( mrbc_string_ptr(&v[0]) + offset, mrbc_string_ptr(&v[1]),
 		   mrbc_string_size(&v[1]) ) == 0);
   }
 
@@ -18,6 +18,7 @@
 /***** System headers *******************************************************/
 //@cond
 #include "vm_config.h"
+#include <stddef.h>
 #include <stdint.h>
 // #include <string.h> causes conflict?
 //@endcond
@@ -34,11 +35,28 @@ extern "C" {
 #define MRBC_STRING_SIZE_T uint16_t
 #endif
 
+// strings shorter than this are stored in the same memory block as RString.
+#if !defined(MRBC_STRING_INLINE_SIZE)
+#define MRBC_STRING_INLINE_SIZE 16
+#endif
+
 /***** Macros ***************************************************************/
 #define RSTRING_LEN(str)	mrbc_string_size(&str)
 #define RSTRING_PTR(str)	mrbc_string_cstr(&str)
 
 /***** Typedefs *************************************************************/
+//================================================================
+/*!@brief
+  String buffer storage type.
+*/
+enum MRBC_STRING_STORAGE {
+  MRBC_STRING_HEAP = 0,	//!< data is allocated separately.
+  MRBC_STRING_STATIC,	//!< data points to read-only memory. (e.g. IREP pool)
+  MRBC_STRING_INLINE,	//!< data points to buf[] in the same block.
+  MRBC_STRING_VIEW,	//!< data points to a part of the parent string.
+};
+
+
 //================================================================
 /*!@brief
   String object.
@@ -49,7 +67,15 @@ typedef struct RString {
   MRBC_OBJECT_HEADER;
 
   MRBC_STRING_SIZE_T size;	//!< string length.
-  uint8_t *data;		//!< pointer to allocated buffer.
+  uint8_t storage;		//!< enum MRBC_STRING_STORAGE
+  uint8_t *data;		//!< pointer to buffer.
+				//!<  not terminated by '\0' if STATIC or VIEW.
+  union {
+    struct RString *parent;	//!< parent string. (MRBC_STRING_VIEW only)
+    uint8_t buf[sizeof(struct RString *)];
+				//!< inline buffer. (MRBC_STRING_INLINE only)
+				//!<  extends to the end of allocated block.
+  };
 
 } mrbc_string;
 
@@ -59,6 +85,10 @@ typedef struct RString {
 mrbc_value mrbc_string_new(struct VM *vm, const void *src, int len);
 mrbc_value mrbc_string_new_cstr(struct VM *vm, const char *src);
 mrbc_value mrbc_string_new_alloc(struct VM *vm, void *buf, int len);
+mrbc_value mrbc_string_new_static(struct VM *vm, const void *buf, int len);
+mrbc_value mrbc_string_new_view(struct VM *vm, mrbc_value *src, int ofs, int len);
+int mrbc_string_detach(mrbc_value *str);
+const char *mrbc_string_cstr_buf(mrbc_value *v, char *buf, int bufsize);
 void mrbc_string_delete(mrbc_value *str);
 void mrbc_string_clear(mrbc_value *str);
 void mrbc_string_clear_vm_id(mrbc_value *str);
@@ -73,6 +103,19 @@ int mrbc_string_chomp(mrbc_value *src);
 
 /***** Inline functions *****************************************************/
 
+//================================================================
+/*! make the buffer writable (copy on write), call before modifying data.
+
+  @param  str	pointer to target value
+  @return	mrbc_error_code
+*/
+static inline int mrbc_string_modifiable(mrbc_value *str)
+{
+  if( str->string->storage != MRBC_STRING_STATIC &&
+      str->string->storage != MRBC_STRING_VIEW ) return 0;
+  return mrbc_string_detach(str);
+}
+
 //================================================================
 /*! compare
 */
@@ -96,13 +139,33 @@ static inline int mrbc_string_size(const mrbc_value *str)
 }
 
 //================================================================
-/*! get c-language string (char *)
+/*! get pointer to the string bytes (may not be terminated by '\0')
 */
-static inline char * mrbc_string_cstr(const mrbc_value *v)
+static inline char * mrbc_string_ptr(const mrbc_value *v)
 {
   return (char*)v->string->data;
 }
 
+//================================================================
+/*! get c-language string (char *)
+
+  @param  v	pointer to target value
+  @return	pointer to c-language string, or NULL if ENOMEM.
+  @note	copies a substring that is not terminated by '\0'.
+	for reading only, use mrbc_string_ptr() and mrbc_string_size(),
+	or mrbc_string_cstr_buf().
+*/
+static inline char * mrbc_string_cstr(mrbc_value *v)
+{
+  mrbc_string *h = v->string;
+  if( (h->storage == MRBC_STRING_STATIC || h->storage == MRBC_STRING_VIEW) &&
+      h->data[h->size] != '\0' ) {
+    if( mrbc_string_detach( v ) != 0 ) return NULL;	// ENOMEM
+  }
+
+  return (char*)h->data;
+}
+
 
 #ifdef __cplusplus
 }
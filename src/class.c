@@ -33,6 +33,7 @@
 #include "c_string.h"
 #include "c_array.h"
 #include "c_hash.h"
+#include "c_fiber.h"
 #include "global.h"
 #include "vm.h"
 #include "load.h"
@@ -42,9 +43,39 @@
 /***** Constant values ******************************************************/
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
+#if MRBC_GLOBAL_METHOD_CACHE_SIZE > 0
+//================================================================
+/*!@brief
+  Global method cache entry.
+*/
+typedef struct GLOBAL_METHOD_CACHE {
+  mrbc_class *cls;		//!< search class.
+  mrbc_sym sym_id;		//!< method name symbol id.
+  uint32_t epoch;		//!< mrbc_method_epoch at cached.
+  mrbc_method method;		//!< found method.
+} mrbc_global_method_cache;
+#endif
+
+
 /***** Function prototypes **************************************************/
 /***** Local variables ******************************************************/
+#if MRBC_GLOBAL_METHOD_CACHE_SIZE > 0
+//! global method cache.
+static mrbc_global_method_cache global_method_cache[MRBC_GLOBAL_METHOD_CACHE_SIZE];
+#endif
+
+
 /***** Global variables *****************************************************/
+//! root of the ivar shape tree. (no instance variables)
+mrbc_shape mrbc_shape_root;
+
+//! method definition epoch. method caches older than this are invalid.
+uint32_t mrbc_method_epoch;
+
+//! method cache hit/miss counters.
+struct MRBC_METHOD_CACHE_STATISTICS mrbc_method_cache_stats;
+
+
 /*! Builtin class table.
 
   @note must be same order as mrbc_vtype.
@@ -71,6 +102,58 @@ mrbc_class * const mrbc_class_tbl[MRBC_TT_MAXVAL+1] = {
 
 /***** Signal catching functions ********************************************/
 /***** Local functions ******************************************************/
+//================================================================
+/*! find method by walking the class hierarchy.
+
+  @param  r_method	pointer to mrbc_method to return values.
+  @param  cls		search class.
+  @param  sym_id	symbol id.
+  @return		pointer to method or NULL.
+*/
+static mrbc_method * find_method_no_cache( mrbc_method *r_method, mrbc_class *cls, mrbc_sym sym_id )
+{
+  do {
+    mrbc_method *method;
+    for( method = cls->method_link; method != 0; method = method->next ) {
+      if( method->sym_id == sym_id ) {
+	*r_method = *method;
+	r_method->cls = cls;
+	return r_method;
+      }
+    }
+
+    struct RBuiltinClass *c = (struct RBuiltinClass *)cls;
+    int right = c->num_builtin_method;
+    if( right == 0 ) goto NEXT;
+    int left = 0;
+
+    while( left < right ) {
+      int mid = (left + right) / 2;
+      if( c->method_symbols[mid] < sym_id ) {
+	left = mid + 1;
+      } else {
+	right = mid;
+      }
+    }
+
+    if( c->method_symbols[right] == sym_id ) {
+      *r_method = (mrbc_method){
+	.type = 'm',
+	.c_func = 2,
+	.sym_id = sym_id,
+	.func = c->method_functions[right],
+	.cls = cls };
+      return r_method;
+    }
+
+  NEXT:
+    cls = cls->super;
+  } while( cls != 0 );
+
+  return 0;
+}
+
+
 /***** Global functions *****************************************************/
 //================================================================
 /*! define class
@@ -128,6 +211,25 @@ mrbc_class * mrbc_define_class(struct VM *vm, const char *name, mrbc_class *supe
   @param  cfunc		pointer to function.
 */
 void mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc)
+{
+  mrbc_define_accessor( vm, cls, name, cfunc, 1, 0 );
+}
+
+
+//================================================================
+/*! define attribute accessor method.
+
+  The VM executes c_func 3 (reader) and 4 (writer) inline using ivar_id.
+  cfunc is used where the VM can not do so.
+
+  @param  vm		pointer to vm.
+  @param  cls		pointer to class.
+  @param  name		method name.
+  @param  cfunc		pointer to function.
+  @param  c_func	1:C Func, 3:attr_reader, 4:attr_writer
+  @param  ivar_id	ivar symbol ID.
+*/
+void mrbc_define_accessor(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc, int c_func, mrbc_sym ivar_id)
 {
   if( cls == NULL ) cls = mrbc_class_object;	// set default to Object.
 
@@ -135,14 +237,80 @@ void mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_f
   if( !method ) return; // ENOMEM
 
   method->type = 'm';
-  method->c_func = 1;
+  method->c_func = c_func;
   method->sym_id = mrbc_str_to_symid( name );
   if( method->sym_id < 0 ) {
     mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
   }
+  method->ivar_id = ivar_id;
   method->func = cfunc;
   method->next = cls->method_link;
   cls->method_link = method;
+
+  mrbc_method_epoch_bump();
+}
+
+
+//================================================================
+/*! find or make the shape that adds an ivar to the shape.
+
+  @param  shape		pointer to current shape.
+  @param  sym_id	ivar symbol ID to add.
+  @return		pointer to new shape or NULL (ENOMEM).
+*/
+static mrbc_shape * shape_transition( mrbc_shape *shape, mrbc_sym sym_id )
+{
+  mrbc_shape *child;
+  for( child = shape->child; child; child = child->sibling ) {
+    if( child->sym_id == sym_id ) return child;
+  }
+
+  // shapes are shared by all VMs, thus never free.
+  child = mrbc_raw_alloc_no_free( sizeof(mrbc_shape) );
+  if( !child ) return NULL;	// ENOMEM
+
+  child->parent = shape;
+  child->child = NULL;
+  child->sibling = shape->child;
+  child->sym_id = sym_id;
+  child->n_ivars = shape->n_ivars + 1;
+  shape->child = child;
+
+  return child;
+}
+
+
+//================================================================
+/*! get the slot index of the ivar.
+
+  @param  shape		pointer to shape.
+  @param  sym_id	ivar symbol ID.
+  @return		slot index or -1 (not found).
+*/
+int mrbc_shape_index( const mrbc_shape *shape, mrbc_sym sym_id )
+{
+  for( ; shape->n_ivars != 0; shape = shape->parent ) {
+    if( shape->sym_id == sym_id ) return shape->n_ivars - 1;
+  }
+  return -1;
+}
+
+
+//================================================================
+/*! get the ivar symbol ID at the slot.
+
+  @param  shape		pointer to shape.
+  @param  index		slot index.
+  @return		symbol ID.
+*/
+mrbc_sym mrbc_shape_symbol( const mrbc_shape *shape, int index )
+{
+  assert( index < shape->n_ivars );
+
+  while( shape->n_ivars != index + 1 ) {
+    shape = shape->parent;
+  }
+  return shape->sym_id;
 }
 
 
@@ -160,14 +328,11 @@ mrbc_value mrbc_instance_new(struct VM *vm, mrbc_class *cls, int size)
   v.instance = mrbc_alloc(vm, sizeof(mrbc_instance) + size);
   if( v.instance == NULL ) return v;	// ENOMEM
 
-  if( mrbc_kv_init_handle(vm, &v.instance->ivar, 0) != 0 ) {
-    mrbc_raw_free(v.instance);
-    v.instance = NULL;
-    return v;
-  }
-
   MRBC_INIT_OBJECT_HEADER( v.instance, "IN" );
+  v.instance->ivar_capa = 0;
   v.instance->cls = cls;
+  v.instance->shape = &mrbc_shape_root;
+  v.instance->ivar = NULL;
 
   return v;
 }
@@ -180,11 +345,43 @@ mrbc_value mrbc_instance_new(struct VM *vm, mrbc_class *cls, int size)
 */
 void mrbc_instance_delete(mrbc_value *v)
 {
-  mrbc_kv_delete_data( &v->instance->ivar );
+  if( v->instance->cls == MRBC_CLASS(Fiber) ) mrbc_fiber_delete( v );
+
+  mrbc_value *p1 = v->instance->ivar;
+  const mrbc_value *p2 = p1 + v->instance->shape->n_ivars;
+  while( p1 < p2 ) {
+    mrbc_decref(p1++);
+  }
+
+  if( v->instance->ivar ) mrbc_raw_free( v->instance->ivar );
   mrbc_raw_free( v->instance );
 }
 
 
+//================================================================
+/*! resize ivar slots.
+
+  @param  inst	pointer to instance.
+  @param  size	num of slots.
+  @return	mrbc_error_code.
+*/
+static int instance_resize_ivar( mrbc_instance *inst, int size )
+{
+  mrbc_value *p;
+  if( inst->ivar ) {
+    p = mrbc_raw_realloc( inst->ivar, sizeof(mrbc_value) * size );
+  } else {
+    p = mrbc_raw_alloc( sizeof(mrbc_value) * size );
+    mrbc_set_vm_id( p, mrbc_get_vm_id(inst) );
+  }
+  if( !p ) return E_NOMEMORY_ERROR;	// ENOMEM
+
+  inst->ivar = p;
+  inst->ivar_capa = size;
+  return 0;
+}
+
+
 //================================================================
 /*! instance variable setter
 
@@ -194,8 +391,30 @@ void mrbc_instance_delete(mrbc_value *v)
 */
 void mrbc_instance_setiv(mrbc_value *obj, mrbc_sym sym_id, mrbc_value *v)
 {
+  mrbc_instance *inst = obj->instance;
+  int idx = mrbc_shape_index( inst->shape, sym_id );
+
   mrbc_incref(v);
-  mrbc_kv_set( &obj->instance->ivar, sym_id, v );
+  if( idx >= 0 ) {
+    mrbc_decref( &inst->ivar[idx] );
+    inst->ivar[idx] = *v;
+    return;
+  }
+
+  // add new ivar.
+  mrbc_shape *shape = shape_transition( inst->shape, sym_id );
+  if( !shape ) goto ENOMEM;
+
+  idx = inst->shape->n_ivars;
+  if( idx >= inst->ivar_capa &&
+      instance_resize_ivar( inst, inst->ivar_capa + 4 ) != 0 ) goto ENOMEM;
+
+  inst->shape = shape;
+  inst->ivar[idx] = *v;
+  return;
+
+ ENOMEM:
+  mrbc_decref(v);
 }
 
 
@@ -208,14 +427,43 @@ void mrbc_instance_setiv(mrbc_value *obj, mrbc_sym sym_id, mrbc_value *v)
 */
 mrbc_value mrbc_instance_getiv(mrbc_value *obj, mrbc_sym sym_id)
 {
-  mrbc_value *v = mrbc_kv_get( &obj->instance->ivar, sym_id );
-  if( !v ) return mrbc_nil_value();
+  int idx = mrbc_shape_index( obj->instance->shape, sym_id );
+  if( idx < 0 ) return mrbc_nil_value();
 
+  mrbc_value *v = &obj->instance->ivar[idx];
   mrbc_incref(v);
   return *v;
 }
 
 
+//================================================================
+/*! copy all instance variables.
+
+  @param  src		pointer to source instance.
+  @param  dst		pointer to destination instance. (no ivars)
+  @return		mrbc_error_code.
+*/
+int mrbc_instance_dup_ivar(const mrbc_value *src, mrbc_value *dst)
+{
+  const mrbc_instance *s = src->instance;
+  mrbc_instance *d = dst->instance;
+  int n = s->shape->n_ivars;
+
+  assert( d->shape->n_ivars == 0 );
+  if( n == 0 ) return 0;
+  if( instance_resize_ivar( d, n ) != 0 ) return E_NOMEMORY_ERROR;
+
+  int i;
+  for( i = 0; i < n; i++ ) {
+    d->ivar[i] = s->ivar[i];
+    mrbc_incref( &d->ivar[i] );
+  }
+  d->shape = s->shape;
+
+  return 0;
+}
+
+
 #if defined(MRBC_ALLOC_VMID)
 //================================================================
 /*! clear vm_id
@@ -225,7 +473,13 @@ mrbc_value mrbc_instance_getiv(mrbc_value *obj, mrbc_sym sym_id)
 void mrbc_instance_clear_vm_id(mrbc_value *v)
 {
   mrbc_set_vm_id( v->instance, 0 );
-  mrbc_kv_clear_vm_id( &v->instance->ivar );
+  if( !v->instance->ivar ) return;
+
+  mrbc_set_vm_id( v->instance->ivar, 0 );
+  int i;
+  for( i = 0; i < v->instance->shape->n_ivars; i++ ) {
+    mrbc_clear_vm_id( &v->instance->ivar[i] );
+  }
 }
 #endif
 
@@ -313,45 +567,40 @@ int mrbc_obj_is_kind_of( const mrbc_value *obj, const mrbc_class *cls )
 */
 mrbc_method * mrbc_find_method( mrbc_method *r_method, mrbc_class *cls, mrbc_sym sym_id )
 {
-  do {
-    mrbc_method *method;
-    for( method = cls->method_link; method != 0; method = method->next ) {
-      if( method->sym_id == sym_id ) {
-	*r_method = *method;
-	r_method->cls = cls;
-	return r_method;
-      }
-    }
+#if MRBC_GLOBAL_METHOD_CACHE_SIZE > 0
+  mrbc_global_method_cache *gc = &global_method_cache[
+	(((uintptr_t)cls >> 2) ^ (uint16_t)sym_id) & (MRBC_GLOBAL_METHOD_CACHE_SIZE - 1) ];
+
+  if( gc->cls == cls && gc->sym_id == sym_id &&
+      gc->epoch == mrbc_method_epoch ) {
+    mrbc_method_cache_stats.global_hit++;
+    *r_method = gc->method;
+    return r_method;
+  }
 
-    struct RBuiltinClass *c = (struct RBuiltinClass *)cls;
-    int right = c->num_builtin_method;
-    if( right == 0 ) goto NEXT;
-    int left = 0;
+  mrbc_method_cache_stats.global_miss++;
+  if( find_method_no_cache( r_method, cls, sym_id ) == 0 ) return 0;
 
-    while( left < right ) {
-      int mid = (left + right) / 2;
-      if( c->method_symbols[mid] < sym_id ) {
-	left = mid + 1;
-      } else {
-	right = mid;
-      }
-    }
+  gc->cls = cls;
+  gc->sym_id = sym_id;
+  gc->epoch = mrbc_method_epoch;
+  gc->method = *r_method;
+  return r_method;
 
-    if( c->method_symbols[right] == sym_id ) {
-      *r_method = (mrbc_method){
-	.type = 'm',
-	.c_func = 2,
-	.sym_id = sym_id,
-	.func = c->method_functions[right],
-	.cls = cls };
-      return r_method;
-    }
+#else
+  return find_method_no_cache( r_method, cls, sym_id );
+#endif
+}
 
-  NEXT:
-    cls = cls->super;
-  } while( cls != 0 );
 
-  return 0;
+//================================================================
+/*! get method cache statistics
+
+  @param  ret	pointer to return value.
+*/
+void mrbc_method_cache_statistics( struct MRBC_METHOD_CACHE_STATISTICS *ret )
+{
+  *ret = mrbc_method_cache_stats;
 }
 
 
@@ -459,9 +708,15 @@ void c_ineffect(struct VM *vm, mrbc_value v[], int argc)
 int mrbc_run_mrblib(const void *bytecode)
 {
   // instead of mrbc_vm_open()
-  mrbc_vm *vm = mrbc_alloc( 0, sizeof(mrbc_vm) );
-  if( !vm ) return -1;	// ENOMEM
+  struct VM_WITH_STACK {
+    mrbc_vm vm;
+    mrbc_vm_stack stack;
+  } *vm_alloc = mrbc_alloc( 0, sizeof(struct VM_WITH_STACK) );
+  if( !vm_alloc ) return -1;	// ENOMEM
+  mrbc_vm *vm = &vm_alloc->vm;
   memset(vm, 0, sizeof(mrbc_vm));
+  mrbc_vm_set_stack( vm, vm_alloc->stack.regs, MAX_REGS_SIZE,
+		     vm_alloc->stack.callinfo, MAX_CALLINFO_COUNT );
 
   if( mrbc_load_mrb(vm, bytecode) ) {
     mrbc_print_exception(&vm->exception);
@@ -474,7 +729,7 @@ int mrbc_run_mrblib(const void *bytecode)
   // instead of mrbc_vm_close()
   mrbc_raw_free( vm->top_irep );	// free only top-level mrbc_irep.
 					// (no need to free child ireps.)
-  mrbc_raw_free( vm );
+  mrbc_raw_free( vm_alloc );
 
   return ret;
 }
@@ -529,6 +784,9 @@ void mrbc_init_class(void)
   cls.cls = MRBC_CLASS(Hash);
   mrbc_set_const( MRBC_SYM(Hash), &cls );
 
+  cls.cls = MRBC_CLASS(Fiber);
+  mrbc_set_const( MRBC_SYM(Fiber), &cls );
+
 #if MRBC_USE_MATH
   cls.cls = MRBC_CLASS(Math);
   mrbc_set_const( MRBC_SYM(Math), &cls );
@@ -65,6 +65,23 @@ struct RBuiltinClass {
 };
 
 
+//================================================================
+/*!@brief
+  Instance variable shape (layout of instance variable slots).
+
+  Shapes form a transition tree from the empty root shape. Objects that
+  set the same instance variables in the same order share one shape,
+  and keep each variable at the same slot index.
+*/
+typedef struct RShape {
+  struct RShape *parent;	//!< shape without the last ivar.
+  struct RShape *child;		//!< first transition from this shape.
+  struct RShape *sibling;	//!< next transition from parent.
+  mrbc_sym sym_id;		//!< last added ivar symbol ID.
+  uint16_t n_ivars;		//!< num of ivars. sym_id is at slot n_ivars-1.
+} mrbc_shape;
+
+
 //================================================================
 /*!@brief
   Instance object.
@@ -74,8 +91,10 @@ struct RBuiltinClass {
 typedef struct RInstance {
   MRBC_OBJECT_HEADER;
 
+  uint16_t ivar_capa;		//!< allocated num of ivar slots.
   struct RClass *cls;
-  struct RKeyValueHandle ivar;
+  struct RShape *shape;		//!< ivar layout.
+  mrbc_value *ivar;		//!< ivar slots.
   uint8_t data[];
 
 } mrbc_instance;
@@ -106,8 +125,9 @@ typedef struct RProc mrb_proc;
 */
 typedef struct RMethod {
   uint8_t type;		//!< M:OP_DEF or OP_ALIAS, m:mrblib or define_method()
-  uint8_t c_func;	//!< 0:IREP, 1:C Func, 2:C Func (built-in)
+  uint8_t c_func;	//!< 0:IREP, 1:C Func, 2:C Func (built-in), 3:attr_reader, 4:attr_writer
   mrbc_sym sym_id;	//!< function names symbol ID
+  mrbc_sym ivar_id;	//!< ivar symbol ID (attr_reader and attr_writer only)
   union {
     struct IREP *irep;	//!< to IREP for ruby proc.
     mrbc_func_t func;	//!< to C function.
@@ -119,7 +139,22 @@ typedef struct RMethod {
 } mrbc_method;
 
 
+//================================================================
+/*!@brief
+  Return value structure for mrbc_method_cache_statistics function.
+*/
+struct MRBC_METHOD_CACHE_STATISTICS {
+  uint32_t inline_hit;		//!< call site cache hit count.
+  uint32_t inline_miss;		//!< call site cache miss count.
+  uint32_t global_hit;		//!< global cache hit count.
+  uint32_t global_miss;		//!< global cache miss count.
+};
+
+
 /***** Global variables *****************************************************/
+extern mrbc_shape mrbc_shape_root;
+extern uint32_t mrbc_method_epoch;
+extern struct MRBC_METHOD_CACHE_STATISTICS mrbc_method_cache_stats;
 extern struct RClass * const mrbc_class_tbl[];
 extern struct RBuiltinClass mrbc_class_Object;
 extern struct RBuiltinClass mrbc_class_NilClass;
@@ -133,6 +168,7 @@ extern struct RBuiltinClass mrbc_class_Array;
 extern struct RBuiltinClass mrbc_class_String;
 extern struct RBuiltinClass mrbc_class_Range;
 extern struct RBuiltinClass mrbc_class_Hash;
+extern struct RBuiltinClass mrbc_class_Fiber;
 extern struct RBuiltinClass mrbc_class_Math;
 extern struct RBuiltinClass mrbc_class_Exception;
 extern struct RClass mrbc_class_NoMemoryError;
@@ -154,16 +190,21 @@ extern struct RClass mrbc_class_ZeroDivisionError;
 /***** Function prototypes **************************************************/
 mrbc_class *mrbc_define_class(struct VM *vm, const char *name, mrbc_class *super);
 void mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc);
+void mrbc_define_accessor(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc, int c_func, mrbc_sym ivar_id);
 mrbc_value mrbc_instance_new(struct VM *vm, mrbc_class *cls, int size);
 void mrbc_instance_delete(mrbc_value *v);
 void mrbc_instance_setiv(mrbc_value *obj, mrbc_sym sym_id, mrbc_value *v);
 mrbc_value mrbc_instance_getiv(mrbc_value *obj, mrbc_sym sym_id);
+int mrbc_instance_dup_ivar(const mrbc_value *src, mrbc_value *dst);
+int mrbc_shape_index(const mrbc_shape *shape, mrbc_sym sym_id);
+mrbc_sym mrbc_shape_symbol(const mrbc_shape *shape, int index);
 void mrbc_instance_clear_vm_id(mrbc_value *v);
 mrbc_value mrbc_proc_new(struct VM *vm, void *irep);
 void mrbc_proc_delete(mrbc_value *val);
 void mrbc_proc_clear_vm_id(mrbc_value *v);
 int mrbc_obj_is_kind_of(const mrbc_value *obj, const mrbc_class *cls);
 mrbc_method *mrbc_find_method(mrbc_method *r_method, mrbc_class *cls, mrbc_sym sym_id);
+void mrbc_method_cache_statistics(struct MRBC_METHOD_CACHE_STATISTICS *ret);
 mrbc_class *mrbc_get_class_by_name(const char *name);
 mrbc_value mrbc_send(struct VM *vm, mrbc_value *v, int reg_ofs, mrbc_value *recv, const char *method_name, int argc, ...);
 void c_ineffect(struct VM *vm, mrbc_value v[], int argc);
@@ -173,6 +214,17 @@ void mrbc_init_class(void);
 
 /***** Inline functions *****************************************************/
 
+//================================================================
+/*! invalidate method caches.
+
+  Must be called whenever a method is added to or removed from any class.
+*/
+static inline void mrbc_method_epoch_bump(void)
+{
+  mrbc_method_epoch++;
+}
+
+
 //================================================================
 /*! find class by object
 
@@ -38,3 +38,13 @@ int hal_write(int fd, const void *buf, int nbytes) {
 // hal_init unimplemented for now...
 void hal_init(void){
 }
+
+// the task queues of rrt0.c are also changed by mrbc_tick() in the
+// vertical interrupt.
+void hal_enable_irq(void){
+  SYS_enableInts();
+}
+
+void hal_disable_irq(void){
+  SYS_disableInts();
+}
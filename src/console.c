@@ -289,9 +289,12 @@ void mrbc_vasprintf(char **buf, int bufsiz, const char *fstr, va_list ap)
 
   INCREASE_BUFFER:
     bufsiz += 64;
-    void *newbuf = mrbc_raw_realloc( pf.buf, bufsiz );
+    int p_ofs = pf.p - pf.buf;	// pf.buf may be freed by the realloc.
+    char *newbuf = mrbc_raw_realloc( pf.buf, bufsiz );
     if( !newbuf ) break;
-    mrbc_printf_replace_buffer( &pf, newbuf, bufsiz );
+    pf.buf = newbuf;
+    pf.buf_end = newbuf + bufsiz - 1;
+    pf.p = newbuf + p_ofs;
     *buf = newbuf;
 
   NEXT_LOOP:
@@ -337,7 +340,7 @@ int mrbc_p_sub(const mrbc_value *v)
 #if MRBC_USE_STRING
   case MRBC_TT_STRING:{
     mrbc_putchar('"');
-    const unsigned char *s = (const unsigned char *)mrbc_string_cstr(v);
+    const unsigned char *s = (const unsigned char *)mrbc_string_ptr(v);
     int i;
     for( i = 0; i < mrbc_string_size(v); i++ ) {
       if( s[i] < ' ' || 0x7f <= s[i] ) {	// tiny isprint()
@@ -448,9 +451,9 @@ int mrbc_print_sub(const mrbc_value *v)
 
 #if MRBC_USE_STRING
   case MRBC_TT_STRING:
-    mrbc_nprint( mrbc_string_cstr(v), mrbc_string_size(v) );
+    mrbc_nprint( mrbc_string_ptr(v), mrbc_string_size(v) );
     if( mrbc_string_size(v) != 0 &&
-	mrbc_string_cstr(v)[ mrbc_string_size(v) - 1 ] == '\n' ) ret = 1;
+	mrbc_string_ptr(v)[ mrbc_string_size(v) - 1 ] == '\n' ) ret = 1;
     break;
 #endif
 
@@ -0,0 +1,60 @@
+/*! @file
+  @brief
+  Binary display list of the slides.
+
+  <pre>
+  Generated from the slide markup by support/compile_slides.rb, and
+  executed by the interpreter in main.c.
+
+  All multi-byte values are big-endian and not aligned.
+
+    "MSL1"                      magic
+    u16 page_count
+    u32 page_offset[page_count + 1]     from the top of the blob.
+    opcode stream of page 0, page 1, ...
+
+  Each page is a sequence of an opcode (u8) followed by its operands,
+  terminated by SL_END. STR is a u8 length followed by the bytes,
+  not terminated by '\0'.
+
+  This file is distributed under BSD 3-Clause License.
+  </pre>
+*/
+
+#ifndef MEGAMRBC_DISPLAY_LIST_H_
+#define MEGAMRBC_DISPLAY_LIST_H_
+
+#define SL_MAGIC "MSL1"
+#define SL_HEADER_SIZE 6	// magic + page_count
+
+//! opcodes. must match OP in support/compile_slides.rb
+enum SLIDE_OPCODE {
+  SL_END       = 0x00,	//!< end of page
+  SL_TEXT      = 0x01,	//!< u8 x, u8 y, STR text
+  SL_TEXT_BG   = 0x02,	//!< u8 x, u8 y, u8 bg palette, STR text
+  SL_TXTPAL    = 0x03,	//!< u8 text palette
+  SL_SETCOLOUR = 0x04,	//!< u8 colour index, u16 colour
+  SL_BGCOL     = 0x05,	//!< u16 background colour
+  SL_IMG       = 0x06,	//!< u8 x, u8 y, STR image name
+  SL_RECT      = 0x07,	//!< u8 x, u8 y, u8 w, u8 h, u8 bg palette (0xff: none)
+  SL_ARROW     = 0x08,	//!< u8 x, u8 y, u8 direction ('r','l','u','d'), u8 length, u8 tee
+  SL_SLEEP     = 0x09,	//!< u16 ticks (1/300s)
+  SL_PLAYSOUND = 0x0a,	//!< (no operand)
+  SL_RENDERBG  = 0x0b,	//!< (no operand)
+  SL_EVENT     = 0x0c,	//!< u8 event. returns to Ruby.
+};
+
+//! events handled by Ruby. must match EVENT in support/compile_slides.rb
+enum SLIDE_EVENT {
+  SL_EV_PAUSE = 0,
+  SL_EV_SHOW_TIMER,
+  SL_EV_HIDE_TIMER,
+  SL_EV_TITLE_SCREEN,
+  SL_EV_DEMO_GAME,
+  SL_EV_SCROLL,
+  SL_EV_INIT_PROGRESS,
+  SL_EV_RESET_TIMER,
+  SL_EV_NUM
+};
+
+#endif
@@ -1,6 +1,19 @@
 #ifndef HAL_H_
 #define HAL_H_
 
+// mrbc_tick() is called by the vertical interrupt, so a tick is a frame.
+// (16ms on NTSC. the sleep times are rounded up to frames.)
+#define MRBC_TICK_UNIT 16
+#define MRBC_TIMESLICE_TICK_COUNT 1
+
+void mrbc_tick(void);
+
+void hal_init(void);
+void hal_enable_irq(void);
+void hal_disable_irq(void);
+// waits for the next frame when no task is ready. see main.c
+void hal_idle_cpu(void);
+
 int hal_write(int fd, const void *buf, int nbytes);
 
 #endif // HAL_H_
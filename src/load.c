@@ -183,7 +183,7 @@ static mrbc_irep * load_irep_1(struct VM *vm, const uint8_t *bin, int *len, int
 
   // num of symbols, offset of tbl_ireps.
   irep.slen = bin_to_uint16(p);		p += 2;
-  int siz = sizeof(mrbc_sym) * irep.slen + sizeof(uint16_t) * irep.plen;
+  int siz = sizeof(mrbc_sym) * irep.slen * 2 + sizeof(uint16_t) * irep.plen;
   siz += (-siz & 0x03);	// padding. 32bit align.
   irep.ofs_ireps = siz >> 2;
 
@@ -201,16 +201,22 @@ static mrbc_irep * load_irep_1(struct VM *vm, const uint8_t *bin, int *len, int
   }
   *p_irep = irep;
 
-  // make a sym_id table.
+  // make a sym_id table, and an instance variable sym_id table.
   mrbc_sym *tbl_syms = mrbc_irep_tbl_syms(p_irep);
+  mrbc_sym *tbl_ivsyms = mrbc_irep_tbl_ivsyms(p_irep);
   for( i = 0; i < irep.slen; i++ ) {
     int siz = bin_to_uint16(p);	p += 2;
     mrbc_sym sym = mrbc_str_to_symid( (const char *)p );
-    if( sym < 0 ) {
+    mrbc_sym ivsym = sym;
+    if( p[0] == '@' && p[1] != '@' ) {
+      ivsym = mrbc_str_to_symid( (const char *)p + 1 );	// skip '@'
+    }
+    if( sym < 0 || ivsym < 0 ) {
       mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
       return NULL;
     }
     *tbl_syms++ = sym;
+    *tbl_ivsyms++ = ivsym;
     p += (siz+1);
   }
 
@@ -218,7 +224,7 @@ static mrbc_irep * load_irep_1(struct VM *vm, const uint8_t *bin, int *len, int
   uint16_t *ofs_pools = mrbc_irep_tbl_pools(p_irep);
   p = p_irep->pool + 2;
   for( i = 0; i < irep.plen; i++ ) {
-    int siz;
+    int siz = 0;
     *ofs_pools++ = (uint16_t)(p - irep.pool);
     switch( *p++ ) {
     case IREP_TT_STR:
@@ -354,7 +360,7 @@ mrbc_value mrbc_irep_pool_value(struct VM *vm, int n)
   case IREP_TT_STR:
   case IREP_TT_SSTR: {
     int len = bin_to_uint16(p);
-    obj = mrbc_string_new( vm, p+2, len );
+    obj = mrbc_string_new_static( vm, p+2, len );	// refer to the pool.
     break;
   }
 #endif
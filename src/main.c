@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <genesis.h>
 #include "resources.h"
+#include "display_list.h"
 #include <bmp.h> // drawline
 
 #define int8_t s8
@@ -216,90 +217,693 @@ void load_tiles() {
   VDP_loadTileData(t_upright, TILE_USERINDEX + t, 1, 0);
 }
 
+// RAM shadow of the visible area of BG_A and BG_B.
+// Primitives build their tiles here and send each rectangle to VRAM with
+// one VDP_setTileMapDataRect(), instead of one VDP_setTileMapXY() per tile.
+// Only the tiles just written by the primitive are sent, so text and
+// images drawn directly to VRAM are never overwritten from the shadow.
+#define TM_WIDTH 40
+#define TM_HEIGHT 28
+#define TM_PLANE_WIDTH 64	// SGDK default plane size
+#define TM_PLANE_HEIGHT 32
+#define TM_MAX_COLOURS 16
+
+// Bounding box of everything drawn on a plane since the last clear,
+// in plane coordinates. x1 and y1 are exclusive, empty if x0 >= x1.
+struct TM_DIRTY {
+  s16 x0, y0, x1, y1;
+};
+
+// Render target of the primitives.
+// tm_screen is the screen itself. tm_offscreen only builds the tilemaps
+// in RAM, and keeps the text palette and colour changes for the flip.
+struct TM_TARGET {
+  u16 plane_a[TM_HEIGHT][TM_WIDTH];
+  u16 plane_b[TM_HEIGHT][TM_WIDTH];
+  struct TM_DIRTY dirty_a;
+  struct TM_DIRTY dirty_b;
+
+  // off-screen only
+  u8 txtpal;
+  u8 num_colours;
+  struct {
+    u8 index;
+    u16 colour;
+  } colours[TM_MAX_COLOURS];
+};
+
+// the dirty box starts out of the screen, so that the first clear is a full one.
+static struct TM_TARGET tm_screen = {
+  .dirty_a = { 0, 0, 0x7fff, 0x7fff },
+  .dirty_b = { 0, 0, 0x7fff, 0x7fff },
+};
+static struct TM_TARGET tm_offscreen;
+static struct TM_TARGET *tm_target = &tm_screen;
+
+static u16 (*tm_shadow(VDPPlane plane))[TM_WIDTH] {
+  return (plane == BG_A) ? tm_target->plane_a : tm_target->plane_b;
+}
+
+static struct TM_DIRTY *tm_dirty(VDPPlane plane) {
+  return (plane == BG_A) ? &tm_target->dirty_a : &tm_target->dirty_b;
+}
+
+// clips the rectangle to the screen. returns false if nothing is left.
+static bool tm_clip(s16 *x, s16 *y, s16 *w, s16 *h) {
+  if(*x < 0) { *w += *x; *x = 0; }
+  if(*y < 0) { *h += *y; *y = 0; }
+  if(*x + *w > TM_WIDTH) *w = TM_WIDTH - *x;
+  if(*y + *h > TM_HEIGHT) *h = TM_HEIGHT - *y;
+
+  return *w > 0 && *h > 0;
+}
+
+static void tm_put(VDPPlane plane, u16 tile, s16 x, s16 y) {
+  if(x < 0 || x >= TM_WIDTH || y < 0 || y >= TM_HEIGHT) return;
+  tm_shadow(plane)[y][x] = tile;
+}
+
+static void tm_fill(VDPPlane plane, u16 tile, s16 x, s16 y, s16 w, s16 h) {
+  if(!tm_clip(&x, &y, &w, &h)) return;
+
+  u16 (*map)[TM_WIDTH] = tm_shadow(plane);
+  for(s16 j = y; j < y + h; j++) {
+    for(s16 i = x; i < x + w; i++) {
+      map[j][i] = tile;
+    }
+  }
+}
+
+// records that a rectangle of the plane has been drawn.
+static void tm_mark(VDPPlane plane, s16 x, s16 y, s16 w, s16 h) {
+  if(w <= 0 || h <= 0) return;
+
+  struct TM_DIRTY *d = tm_dirty(plane);
+  if(d->x0 >= d->x1) {
+    d->x0 = x;
+    d->y0 = y;
+    d->x1 = x + w;
+    d->y1 = y + h;
+    return;
+  }
+  if(x < d->x0) d->x0 = x;
+  if(y < d->y0) d->y0 = y;
+  if(x + w > d->x1) d->x1 = x + w;
+  if(y + h > d->y1) d->y1 = y + h;
+}
+
+static void tm_mark_image(VDPPlane plane, const Image *image, s16 x, s16 y) {
+  tm_mark(plane, x, y, image->tilemap->w, image->tilemap->h);
+}
+
+// sends a rectangle of the shadow to VRAM.
+static void tm_flush(VDPPlane plane, s16 x, s16 y, s16 w, s16 h) {
+  if(!tm_clip(&x, &y, &w, &h)) return;
+  if(tm_target == &tm_screen) {
+    VDP_setTileMapDataRect(plane, &tm_shadow(plane)[y][x], x, y, w, h, TM_WIDTH, DMA);
+  }
+  tm_mark(plane, x, y, w, h);
+}
+
+// writes a single tile through the shadow.
+static void tm_set(VDPPlane plane, u16 tile, s16 x, s16 y) {
+  if(x < 0 || x >= TM_WIDTH || y < 0 || y >= TM_HEIGHT) return;
+  tm_shadow(plane)[y][x] = tile;
+  if(tm_target == &tm_screen) {
+    VDP_setTileMapXY(plane, tile, x, y);
+  }
+  tm_mark(plane, x, y, 1, 1);
+}
+
+// Clears what has been drawn on the plane since the last clear.
+// A small area is blanked from the shadow. When most of the screen, or
+// anything outside of it, has been drawn, the whole plane is cleared
+// by a single DMA fill (tile 0 is blank, same as blnk).
+static void tm_clear(VDPPlane plane) {
+  struct TM_DIRTY *d = tm_dirty(plane);
+  s16 w = d->x1 - d->x0;
+  s16 h = d->y1 - d->y0;
+  if(w <= 0 || h <= 0) return;
+
+  if(d->x0 < 0 || d->y0 < 0 || d->x1 > TM_WIDTH || d->y1 > TM_HEIGHT ||
+     w * h > TM_WIDTH * TM_HEIGHT / 2) {
+    if(tm_target == &tm_screen) VDP_clearPlane(plane, TRUE);
+    memset(tm_shadow(plane), 0, sizeof(tm_screen.plane_a));
+  } else {
+    tm_fill(plane, TILE_USERINDEX + blnk, d->x0, d->y0, w, h);
+    tm_flush(plane, d->x0, d->y0, w, h);
+  }
+
+  d->x0 = d->y0 = d->x1 = d->y1 = 0;
+}
+
+static void set_text_palette(u8 pal) {
+  if(tm_target == &tm_screen) {
+    VDP_setTextPalette(pal);
+  } else {
+    tm_target->txtpal = pal;
+  }
+}
+
+// off-screen, the change is kept until the flip.
+// returns false if there is no more room for it.
+static bool set_colour(u8 index, u16 colour) {
+  if(tm_target == &tm_screen) {
+    PAL_setColor(index, colour);
+    return TRUE;
+  }
+
+  if(tm_target->num_colours >= TM_MAX_COLOURS) return FALSE;
+  tm_target->colours[tm_target->num_colours].index = index;
+  tm_target->colours[tm_target->num_colours].colour = colour;
+  tm_target->num_colours++;
+  return TRUE;
+}
+
+// tile of a character, same as VDP_drawText() with the text palette pal.
+static u16 text_tile(u8 pal, char ch) {
+  u8 c = ch - 32;
+  return TILE_ATTR(pal, VDP_getTextPriority(), FALSE, FALSE) + TILE_FONTINDEX + ((c < FONT_LEN) ? c : 0);
+}
+
+// draws len bytes of (not terminated) text. Text past the screen width
+// goes on to the rest of the plane, as VDP_drawText() does; it is clipped
+// at the edge of the plane (or of the off-screen shadow).
+static void draw_text_n(const char *text, int len, char x, char y)
+{
+  char str[TM_WIDTH + 1];
+
+  if(tm_target != &tm_screen) {
+    for(int i = 0; i < len; i++) {
+      tm_put(BG_A, text_tile(tm_target->txtpal, text[i]), x + i, y);
+    }
+    tm_mark(BG_A, x, y, len, 1);
+    return;
+  }
+
+  // VDP_drawText() takes a terminated string, a screen width at a time.
+  for(int i = 0; i < len && x + i < TM_PLANE_WIDTH; i += TM_WIDTH) {
+    int n = (len - i < TM_WIDTH) ? len - i : TM_WIDTH;
+    memcpy(str, text + i, n);
+    str[n] = '\0';
+    VDP_drawText(str, x + i, y);
+  }
+  tm_mark(BG_A, x, y, len, 1);
+}
+
+// fills the background of len tiles with bgpal_num
+static void draw_bg_n(int len, char bgpal_num, char x, char y)
+{
+  tm_fill(BG_B, TILE_ATTR_FULL(bgpal_num, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgfull), x, y, len, 1);
+  tm_flush(BG_B, x, y, len, 1);
+}
+
+// Streaming of image tilesets over several frames.
+// A big tileset takes more than one vblank to DMA, so the tiles are sent
+// in chunks of STREAM_TILES_PER_FRAME from vblank(), and the tilemap
+// is drawn once all of them are in VRAM. Jobs are done in FIFO order.
+#define STREAM_QUEUE_SIZE 8
+#define STREAM_TILES_PER_FRAME 128	// 4KB, leaves room for the sprites.
+
+static struct STREAM_JOB {
+  const Image *image;
+  u16 base;		// VRAM tile index.
+  u16 sent;		// num of tiles queued so far.
+  bool draw;		// draw the tilemap when all tiles are sent.
+  VDPPlane plane;
+  u16 pal;
+  u16 x, y;
+} stream_jobs[STREAM_QUEUE_SIZE];
+static u8 stream_head = 0;
+static u8 stream_count = 0;
+
+static struct STREAM_JOB *stream_job(u8 n) {
+  return &stream_jobs[(stream_head + n) % STREAM_QUEUE_SIZE];
+}
+
+static bool stream_pending(const Image *image) {
+  for(u8 n = 0; n < stream_count; n++) {
+    if(stream_job(n)->image == image) return TRUE;
+  }
+  return FALSE;
+}
+
+static void draw_image_tilemap(VDPPlane plane, const Image *image, u16 base, u16 pal, u16 x, u16 y) {
+  VDP_setTileMapEx(
+    plane, image->tilemap,
+    TILE_ATTR_FULL(pal, FALSE, FALSE, FALSE, base),
+    x, y, 0, 0, image->tilemap->w, image->tilemap->h, DMA
+  );
+  tm_mark_image(plane, image, x, y);
+}
+
+// Queues this frame's share of the tiles to the DMA queue of SGDK,
+// which sends them in the next vblank.
+static void stream_step() {
+  u16 budget = STREAM_TILES_PER_FRAME;
+
+  for(u8 n = 0; n < stream_count && budget > 0; n++) {
+    struct STREAM_JOB *job = stream_job(n);
+    const TileSet *tileset = job->image->tileset;
+    u16 len = tileset->numTile - job->sent;
+    if(len > budget) len = budget;
+    if(len == 0) continue;
+
+    if(!DMA_queueDma(DMA_VRAM, (void *)(tileset->tiles + job->sent * 8),
+                     (job->base + job->sent) * 32, len * 16, 2)) break;
+    job->sent += len;
+    budget -= len;
+  }
+}
+
+// Draws the images whose tiles have all been sent. Call after the vblank.
+static void stream_finish() {
+  while(stream_count > 0) {
+    struct STREAM_JOB *job = stream_job(0);
+    if(job->sent < job->image->tileset->numTile) break;
+
+    if(job->draw) {
+      draw_image_tilemap(job->plane, job->image, job->base, job->pal, job->x, job->y);
+    }
+    stream_head = (stream_head + 1) % STREAM_QUEUE_SIZE;
+    stream_count--;
+  }
+}
+
+// Completes all jobs right now.
+static void stream_flush() {
+  DMA_flushQueue();
+  for(u8 n = 0; n < stream_count; n++) {
+    struct STREAM_JOB *job = stream_job(n);
+    const TileSet *tileset = job->image->tileset;
+    if(job->sent < tileset->numTile) {
+      VDP_loadTileData(tileset->tiles + job->sent * 8, job->base + job->sent,
+                       tileset->numTile - job->sent, DMA);
+      job->sent = tileset->numTile;
+    }
+  }
+  stream_finish();
+}
+
+// the images of the previous page must not be drawn on the new one.
+// their tiles are still sent, and stay in the cache.
+static void stream_cancel_draws() {
+  for(u8 n = 0; n < stream_count; n++) {
+    stream_job(n)->draw = FALSE;
+  }
+}
+
+// Frame time statistics, in scanlines.
+// A frame is busy (VM, rendering, ...) from the return of a vblank wait
+// until the next wait. If a vertical interrupt comes in between, the
+// frame missed its vblank. Not static, so that a host build can read it.
+struct FRAME_STATS {
+  u32 frames;		// frames waited for
+  u32 overruns;		// frames that missed their vblank
+  u16 last;		// busy scanlines of the last frame
+  u16 worst;		// busy scanlines of the worst frame
+  u32 total;		// busy scanlines of all frames
+  u16 input_lag;	// most frames from a button press to its handling
+} frame_stats;
+
+static u32 frame_start_vtimer;
+static u16 frame_start_line;
+static bool frame_meter;	// raster bar of the busy scanlines
+
+#define FRAME_METER_COLOUR 31	// green text colour
+
+static u16 frame_lines() {
+  return IS_PALSYSTEM ? 313 : 262;
+}
+
+// scanlines since the last vertical interrupt, when vtimer was updated.
+static u16 frame_line(u32 *timer) {
+  u32 t;
+  u16 line;
+
+  do {
+    t = vtimer;
+    line = VDP_getAdjustedVCounter();
+  } while(t != vtimer);
+  *timer = t;
+
+  u16 height = VDP_getScreenHeight();
+  return (line >= height) ? line - height : line + frame_lines() - height;
+}
+
+static void frame_begin() {
+  frame_start_line = frame_line(&frame_start_vtimer);
+  if(frame_meter) VDP_setBackgroundColor(FRAME_METER_COLOUR);
+}
+
+static void frame_end() {
+  u32 timer;
+  u16 line = frame_line(&timer);
+  u32 busy = (timer - frame_start_vtimer) * frame_lines() + line - frame_start_line;
+
+  if(frame_meter) VDP_setBackgroundColor(0);
+  frame_stats.frames++;
+  if(timer != frame_start_vtimer) frame_stats.overruns++;
+  frame_stats.last = (busy > 0xffff) ? 0xffff : busy;
+  if(frame_stats.last > frame_stats.worst) frame_stats.worst = frame_stats.last;
+  frame_stats.total += busy;
+}
+
+// SYS_doVBlankProcess(), with the frame time measured.
+static void wait_vint() {
+  frame_end();
+  SYS_doVBlankProcess();
+  frame_begin();
+}
+
+// Waits for the vblank, sending the streamed tiles in it.
+static void vblank() {
+  stream_step();
+  wait_vint();
+  stream_finish();
+}
+
+// Tasks.
+// The C methods called from a task yield by making the task wait. The
+// scheduler (rrt0.c) switches task after the call, and waits for the
+// next frame when no task is ready.
+#define TICKS_PER_FRAME (IS_PALSYSTEM ? 6 : 5)	// getTick() is 1/300s
+
+// A Fiber runs inside the task that resumed it, and can't make the task
+// wait. It should Fiber.yield to its frame loop instead.
+static mrbc_tcb *task_of(mrb_vm *vm) {
+  if(!vm->flag_fiber) return MRBC_VM2TCB(vm);
+  mrbc_raise(vm, MRBC_CLASS(RuntimeError), "can't wait in a Fiber");
+  return NULL;
+}
+
+static void task_sleep_frames(mrb_vm *vm, u16 frames) {
+  mrbc_tcb *tcb = task_of(vm);
+  if(tcb && frames > 0) mrbc_sleep_ms(tcb, (u32)frames * MRBC_TICK_UNIT);
+}
+
+static u16 ticks_to_frames(u16 ticks) {
+  return (ticks + TICKS_PER_FRAME - 1) / TICKS_PER_FRAME;
+}
+
+// VRAM tile cache of the images.
+// A tileset stays in VRAM after its image is drawn, and is reused when the
+// same image is drawn again. Each image gets its own range of tiles, so
+// the images of a page can coexist. When VRAM is full, the least recently
+// used images that are not on the current page are evicted.
+#define SPRITE_VRAM_TILES 420	// taken by SPR_init() at the end of the user area
+#define IMAGE_TILE_BASE (TILE_USERINDEX + last + 1)
+#define IMAGE_TILE_END (TILE_USERINDEX + TILE_USERLENGTH - SPRITE_VRAM_TILES)
+#define IMAGE_CACHE_SIZE 16
+
+static struct IMAGE_CACHE {
+  const Image *image;	// NULL if not used.
+  u16 base;		// first VRAM tile index.
+  u16 size;		// num of tiles.
+  u32 last_use;
+} image_cache[IMAGE_CACHE_SIZE];
+static u32 image_cache_clock = 0;
+static u32 image_cache_page_start = 0;	// clock at the start of the current page.
+
+// images drawn so far are not on the screen any more.
+static void image_cache_new_page() {
+  image_cache_page_start = ++image_cache_clock;
+  stream_cancel_draws();
+}
+
+// first-fit free range of size tiles. returns -1 if there is none.
+static s32 image_cache_find_space(u16 size) {
+  for(s16 i = -1; i < IMAGE_CACHE_SIZE; i++) {
+    u16 start;
+    if(i < 0) {
+      start = IMAGE_TILE_BASE;
+    } else if(image_cache[i].image) {
+      start = image_cache[i].base + image_cache[i].size;
+    } else {
+      continue;
+    }
+    if(start + size > IMAGE_TILE_END) continue;
+
+    s16 j;
+    for(j = 0; j < IMAGE_CACHE_SIZE; j++) {
+      struct IMAGE_CACHE *e = &image_cache[j];
+      if(e->image && start < e->base + e->size && e->base < start + size) break;
+    }
+    if(j == IMAGE_CACHE_SIZE) return start;
+  }
+
+  return -1;
+}
+
+// least recently used image, preferably not on the current page.
+static struct IMAGE_CACHE *image_cache_victim() {
+  struct IMAGE_CACHE *victim = NULL;
+
+  for(s16 i = 0; i < IMAGE_CACHE_SIZE; i++) {
+    struct IMAGE_CACHE *e = &image_cache[i];
+    if(!e->image) continue;
+    if(!victim) {
+      victim = e;
+      continue;
+    }
+    bool e_on_page = e->last_use >= image_cache_page_start;
+    bool victim_on_page = victim->last_use >= image_cache_page_start;
+    if(e_on_page != victim_on_page) {
+      if(victim_on_page) victim = e;
+    } else if(e->last_use < victim->last_use) {
+      victim = e;
+    }
+  }
+
+  return victim;
+}
+
+// Returns the cache entry of the image, with its tiles in VRAM. When
+// load is FALSE, the tiles of a new entry are left to the caller.
+static struct IMAGE_CACHE *image_cache_get(const Image *image, bool load, bool *hit) {
+  struct IMAGE_CACHE *e = NULL;
+  s32 base = -1;
+  s16 i;
+
+  image_cache_clock++;
+  for(i = 0; i < IMAGE_CACHE_SIZE; i++) {
+    if(image_cache[i].image == image) {
+      image_cache[i].last_use = image_cache_clock;
+      if(load && stream_pending(image)) stream_flush();
+      *hit = TRUE;
+      return &image_cache[i];
+    }
+  }
+
+  u16 size = image->tileset->numTile;
+  while(1) {
+    for(i = 0; i < IMAGE_CACHE_SIZE; i++) {
+      if(!image_cache[i].image) break;
+    }
+    if(i < IMAGE_CACHE_SIZE) {
+      e = &image_cache[i];
+      base = image_cache_find_space(size);
+      if(base >= 0) break;
+    }
+
+    struct IMAGE_CACHE *victim = image_cache_victim();
+    if(!victim) break;
+    if(stream_pending(victim->image)) stream_flush();
+    victim->image = NULL;
+  }
+  // larger than the whole area. same as before the cache.
+  if(base < 0) base = IMAGE_TILE_BASE;
+
+  if(load) VDP_loadTileSet(image->tileset, base, DMA);
+  e->image = image;
+  e->base = base;
+  e->size = size;
+  e->last_use = image_cache_clock;
+
+  *hit = FALSE;
+  return e;
+}
+
+// Returns the VRAM tile index of the image's tileset, loading it if needed.
+static u16 image_tiles(const Image *image) {
+  bool hit;
+  return image_cache_get(image, TRUE, &hit)->base;
+}
+
+// draws the image using its cached tileset. The palette is not loaded.
+static void draw_cached_image(VDPPlane plane, const Image *image, u16 pal, u16 x, u16 y) {
+  draw_image_tilemap(plane, image, image_tiles(image), pal, x, y);
+}
+
+// Same as draw_cached_image, but a tileset that is not in VRAM yet is
+// streamed in over the next frames, and the image appears after that.
+static void stream_cached_image(VDPPlane plane, const Image *image, u16 pal, u16 x, u16 y) {
+  bool hit;
+
+  if(stream_count >= STREAM_QUEUE_SIZE) stream_flush();
+
+  struct IMAGE_CACHE *e = image_cache_get(image, FALSE, &hit);
+  if(hit && !stream_pending(image)) {
+    draw_image_tilemap(plane, image, e->base, pal, x, y);
+    return;
+  }
+
+  struct STREAM_JOB *job = stream_job(stream_count++);
+  job->image = image;
+  job->base = e->base;
+  job->sent = hit ? image->tileset->numTile : 0;    // hit: behind the job sending the tiles.
+  job->draw = TRUE;
+  job->plane = plane;
+  job->pal = pal;
+  job->x = x;
+  job->y = y;
+
+  // DMA can't send packed tiles.
+  if(!hit && image->tileset->compression != COMPRESSION_NONE) {
+    VDP_loadTileSet(image->tileset, e->base, DMA);
+    job->sent = image->tileset->numTile;
+  }
+}
+
+// Syntax highlighting of a line of code. Same colours as code_line in
+// support/compile_slides.rb: text palette 1 for constants, 3 for keywords,
+// 2 for strings and 0 for the rest.
+static const char * const code_keywords[] = {
+  "do", "end", "if", "unless", "else", "elsif", "while", "for", "class", "def",
+};
+
+static u8 code_term_palette(const char *term, int len) {
+  if(term[0] >= 'A' && term[0] <= 'Z') return 1;
+
+  for(u8 i = 0; i < sizeof(code_keywords) / sizeof(code_keywords[0]); i++) {
+    if(strlen(code_keywords[i]) == len && memcmp(code_keywords[i], term, len) == 0) return 3;
+  }
+  return 0;
+}
+
+struct CODE_LINE {
+  char text[TM_WIDTH];
+  u8 pal[TM_WIDTH];
+  u8 len;
+};
+
+static void code_put(struct CODE_LINE *line, char c, u8 pal) {
+  if(line->len >= TM_WIDTH) return;
+  line->text[line->len] = c;
+  line->pal[line->len] = pal;
+  line->len++;
+}
+
+// Splits text (outside of strings) into words and runs of spaces, same as
+// break_line in support/compile_slides.rb.
+static void code_put_terms(struct CODE_LINE *line, const char *text, int len) {
+  int start = 0;
+
+  for(int i = 1; i <= len; i++) {
+    if(i < len && (text[i] == ' ') == (text[start] == ' ')) continue;
+
+    u8 pal = code_term_palette(text + start, i - start);
+    for(int j = start; j < i; j++) code_put(line, text[j], pal);
+    start = i;
+  }
+}
+
+// Draws len bytes of code with its colours, in one tilemap write.
+// The text palette is not changed.
+static void draw_code_n(const char *text, int len, s16 x, s16 y) {
+  struct CODE_LINE line;
+  int start = 0;
+  int field = 0;
+
+  line.len = 0;
+
+  // fields separated by '"'. odd fields are strings. As String#split,
+  // trailing empty fields are dropped, and a last open string is closed.
+  while(len > 0 && text[len - 1] == '"') len--;
+  for(int i = 0; i <= len; i++) {
+    if(i < len && text[i] != '"') continue;
+
+    if(field % 2 == 0) {
+      code_put_terms(&line, text + start, i - start);
+    } else {
+      code_put(&line, '"', 2);
+      for(int j = start; j < i; j++) code_put(&line, text[j], 2);
+      code_put(&line, '"', 2);
+    }
+    field++;
+    start = i + 1;
+  }
+
+  for(u8 i = 0; i < line.len; i++) {
+    tm_put(BG_A, text_tile(line.pal[i], line.text[i]), x + i, y);
+  }
+  tm_flush(BG_A, x, y, line.len, 1);
+}
+
 // C functions to be called from mruby
 static void c_megamrbc_draw_text(mrb_vm *vm, mrb_value *v, int argc)
 {
-  char *str = mrbc_string_cstr(&v[1]);
+  // the string may be an unterminated view of the page.
   char x = mrbc_integer(v[2]);
   char y = mrbc_integer(v[3]);
-  VDP_drawText(str, x, y);
+  draw_text_n(mrbc_string_ptr(&v[1]), mrbc_string_size(&v[1]), x, y);
 }
 
 static void c_megamrbc_draw_top_left(mrb_vm *vm, mrb_value *v, int argc)
 {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_USERINDEX + tl, x, y);
+  tm_set(BG_A, TILE_USERINDEX + tl, x, y);
 }
 
 static void c_megamrbc_draw_horizontal(mrb_vm *vm, mrb_value *v, int argc)
 {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_USERINDEX + horiz, x, y);
+  tm_set(BG_A, TILE_USERINDEX + horiz, x, y);
 }
 
 static void c_megamrbc_draw_top_right(mrb_vm *vm, mrb_value *v, int argc)
 {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_ATTR_FULL(0,HIPRIO,VNOFLIP,HFLIP, TILE_USERINDEX + tl), x, y);
+  tm_set(BG_A, TILE_ATTR_FULL(0,HIPRIO,VNOFLIP,HFLIP, TILE_USERINDEX + tl), x, y);
 }
 
 static void c_megamrbc_draw_vertical(mrb_vm *vm, mrb_value *v, int argc)
 {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_USERINDEX + vert, x, y);
+  tm_set(BG_A, TILE_USERINDEX + vert, x, y);
 }
 
 static void c_megamrbc_draw_bottom_left(mrb_vm *vm, mrb_value *v, int argc)
 {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_ATTR_FULL(0,HIPRIO,VFLIP,HNOFLIP, TILE_USERINDEX + tl), x, y);
+  tm_set(BG_A, TILE_ATTR_FULL(0,HIPRIO,VFLIP,HNOFLIP, TILE_USERINDEX + tl), x, y);
 }
 
 static void c_megamrbc_draw_bottom_right(mrb_vm *vm, mrb_value *v, int argc)
 {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_ATTR_FULL(0,HIPRIO,VFLIP,HFLIP, TILE_USERINDEX + tl), x, y);
+  tm_set(BG_A, TILE_ATTR_FULL(0,HIPRIO,VFLIP,HFLIP, TILE_USERINDEX + tl), x, y);
 }
 
+// the task sleeps until the next frame.
 static void c_megamrbc_wait_vblank(mrb_vm *vm, mrb_value *v, int argc) {
-  SPR_update();
-  SYS_doVBlankProcess();
+  task_sleep_frames(vm, 1);
 }
 
 static void c_megamrbc_show_tick(mrb_vm *vm, mrb_value *v, int argc) {
   uint8_t x = mrbc_integer(v[1]);
   uint8_t y = mrbc_integer(v[2]);
-  uint16_t x_px = (x + 1) * 8;
-  uint16_t y_px = (y + 1) * 8;
-  VDP_setTileMapXY(BG_B, TILE_USERINDEX + tck, x, y);
+  tm_set(BG_B, TILE_USERINDEX + tck, x, y);
 }
 
-static void draw_colour_square(uint8_t palette_num, mrb_vm *vm, mrb_value *v, int argc) {
-  uint8_t x = mrbc_integer(v[1]);
-  uint8_t y = mrbc_integer(v[2]);
-  uint16_t x_px = (x + 1) * 8;
-  uint16_t y_px = (y + 1) * 8;
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x-1, y-1);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgt), x, y-1);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgtl), x+1, y-1);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgl), x-1, y);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgfull), x, y);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgl), x+1, y);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x-1, y+1);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgt), x, y+1);
-  VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(palette_num, LOPRIO, VFLIP, HFLIP, TILE_USERINDEX + bgtl), x+1, y+1);
-}
-
-static void c_megamrbc_clear_screen(mrb_vm *vm, mrb_value *v, int argc) {
-  uint8_t x = 0;
-  uint8_t y = 0;
-
+// colours, text palette and scroll offset of a new page.
+static void reset_page_state() {
 // some "base" colours
   PAL_setColor(15, 0x0FFF); // default text colour
   PAL_setColor(31, 0x02F2); // TODO: sort out colour setting
@@ -309,13 +913,19 @@ static void c_megamrbc_clear_screen(mrb_vm *vm, mrb_value *v, int argc) {
   // also reset scroll offset
   VDP_setHorizontalScroll(BG_B, 0);
   VDP_setHorizontalScroll(BG_A, 0);
+}
 
-  for(y = 0; y < 28; y++) {
-    for(x = 0; x < 40; x++) {
-      VDP_setTileMapXY(BG_B, TILE_USERINDEX + blnk, x, y);
-      VDP_setTileMapXY(BG_A, TILE_USERINDEX + blnk, x, y);
-    }
-  }
+static void clear_screen() {
+  reset_page_state();
+  image_cache_new_page();
+
+  // only what the previous page has drawn.
+  tm_clear(BG_B);
+  tm_clear(BG_A);
+}
+
+static void c_megamrbc_clear_screen(mrb_vm *vm, mrb_value *v, int argc) {
+  clear_screen();
 }
 
 static void c_megamrbc_call_rand(mrb_vm *vm, mrb_value *v, int argc) {
@@ -329,29 +939,21 @@ Sprite* spikes_obj;
 
 static void c_megamrbc_render_start_bg(mrb_vm *vm, mrb_value *v, int argc) {
   PAL_setPaletteDMA(PAL0, sky_bg.palette->data);
-  VDP_drawImageEx(
-    BG_B, &sky_bg,
-    TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USERINDEX + last + 1),
-    0, 0, FALSE, TRUE
-  );
+  draw_cached_image(BG_B, &sky_bg, PAL0, 0, 0);
 }
 
 static void c_megamrbc_render_start_logo(mrb_vm *vm, mrb_value *v, int argc) {
   bool dash_or_plus = mrbc_integer(v[1]);
-  Image logo_image = main_logo;
+  const Image *logo_image = &main_logo;
 
   // use wombat palette which includes main logo palette
   VDP_setPalette(PAL1, wombat0.palette->data);
   if(dash_or_plus == 1) {
-    logo_image = main_logo_dash;
+    logo_image = &main_logo_dash;
   } else if(dash_or_plus == 2) {
-    logo_image = main_logo_dashplus;
+    logo_image = &main_logo_dashplus;
   }
-  VDP_drawImageEx(
-    BG_A, &logo_image,
-    TILE_ATTR_FULL(PAL1, FALSE, FALSE, FALSE, TILE_USERINDEX + last + 1 + sky_bg.tileset->numTile),
-    5, 10, FALSE, TRUE
-  );
+  draw_cached_image(BG_A, logo_image, PAL1, 5, 10);
 }
 
 static void init_ninjas() {
@@ -368,19 +970,14 @@ static void init_ninjas() {
   SPR_setVisibility(spikes_obj, HIDDEN);
 }
 
-static void c_megamrbc_show_game_bg(mrb_vm *vm, mrb_value *v, int argc) {
+static void show_game_bg() {
   PAL_setPaletteDMA(PAL0, sky_bg.palette->data);
-  VDP_drawImageEx(
-    BG_B, &sky_bg,
-    TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USERINDEX + last + 1),
-    0, 0, FALSE, TRUE
-  );
+  draw_cached_image(BG_B, &sky_bg, PAL0, 0, 0);
+  draw_cached_image(BG_A, &mountains_bg, PAL0, 0, 28);
+}
 
-  VDP_drawImageEx(
-    BG_A, &mountains_bg,
-    TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USERINDEX + last + 1 + sky_bg.tileset->numTile),
-    0, 28, FALSE, TRUE
-  );
+static void c_megamrbc_show_game_bg(mrb_vm *vm, mrb_value *v, int argc) {
+  show_game_bg();
 }
 
 static void c_megamrbc_show_runner(mrb_vm *vm, mrb_value *v, int argc) {
@@ -421,58 +1018,65 @@ static void c_megamrbc_hide_runner(mrb_vm *vm, mrb_value *v, int argc) {
   SPR_setVisibility(ninja32black_obj, HIDDEN);
 }
 
-static void c_megamrbc_read_page_at(mrb_vm *vm, mrb_value *v, int argc) {
-  uint16_t target_idx = mrbc_integer(v[1]);
+// Page index of the content blob, built once on boot.
+// Page i is content[page_offsets[i]] up to (not including)
+// content[page_offsets[i+1] - 1], which is the '=' of the separator or
+// the terminating '\0'.
+static u32 *page_offsets = NULL;
+static u16 page_total = 0;
+
+// Pages are separated by a line consisting of a single '='.
+static bool is_page_separator(u32 idx) {
+  return content[idx] == '=' && idx != 0 &&
+    content[idx-1] == '\n' && content[idx+1] == '\n';
+}
 
-  uint16_t length = strlen(content);
-  uint16_t idx = 0;
-  uint16_t count = 0;
+static void build_page_index() {
+  u32 idx;
+  u16 count = 1;
 
-  while(content[idx] && count < target_idx) {
-    if(content[idx] == '=' && idx != 0 && content[idx-1] == '\n' && idx < length && content[idx+1] == '\n') {
-      count++;
-    }
-    idx++;
+  for(idx = 0; content[idx]; idx++) {
+    if(is_page_separator(idx)) count++;
   }
 
-  // reatched the end of content
-  if(!content[idx]) {
-    SET_RETURN(mrbc_nil_value());
+  page_offsets = mrbc_raw_alloc_no_free((count + 1) * sizeof(u32));
+  if(!page_offsets) {
+    KLog("out of memory for page index");
     return;
   }
 
-  //idx += 2;
-  const u8* page_start = content + idx;
-  mrbc_value page_content = mrbc_nil_value();
-  while(1) {
-    bool input_ended = content[idx] == '\0';
-    bool page_ended = content[idx] == '=' &&
-      content[idx-1] == '\n' && idx < length && content[idx+1] == '\n';
+  page_offsets[0] = 0;
+  count = 1;
+  for(idx = 0; content[idx]; idx++) {
+    if(is_page_separator(idx)) page_offsets[count++] = idx + 1;
+  }
+  page_offsets[count] = idx + 1;
+  page_total = count;
+}
 
-    if (input_ended || page_ended) {
-      page_content = mrbc_string_new(vm, page_start, content + idx - page_start);
-      break;
-    }
+static void c_megamrbc_read_page_at(mrb_vm *vm, mrb_value *v, int argc) {
+  mrbc_int target_idx = mrbc_integer(v[1]);
 
-    idx++;
+  if(target_idx < 0 || target_idx >= page_total) {
+    SET_RETURN(mrbc_nil_value());
+    return;
   }
 
-  SET_RETURN(page_content);
-}
+  u32 start = page_offsets[target_idx];
+  u32 end = page_offsets[target_idx + 1] - 1;
 
-// Reads content and counts the page count. Does not cache so this is slow
-static void c_megamrbc_page_count(mrb_vm *vm, mrb_value *v, int argc) {
-  uint16_t length = strlen(content);
-  uint16_t idx = 0;
-  uint16_t size = 1;
-  while(content[idx]) {
-    if(content[idx] == '=' && idx != 0 && content[idx-1] == '\n' && idx < length && content[idx+1] == '\n') {
-      size++;
-    }
-    idx++;
+  // reatched the end of content
+  if(!content[start]) {
+    SET_RETURN(mrbc_nil_value());
+    return;
   }
 
-  SET_RETURN(mrbc_integer_value(size));
+  // content is in ROM, share it instead of copying the page.
+  SET_RETURN(mrbc_string_new_static(vm, content + start, end - start));
+}
+
+static void c_megamrbc_page_count(mrb_vm *vm, mrb_value *v, int argc) {
+  SET_RETURN(mrbc_integer_value(page_total));
 }
 
 static void c_megamrbc_set_pal_colour(mrb_vm *vm, mrb_value *v, int argc) {
@@ -496,6 +1100,88 @@ static void c_megamrbc_read_joypad(mrb_vm *vm, mrb_value *v, int argc) {
   SET_INT_RETURN(joy_pressed);
 }
 
+// Queue of joypad events.
+// joy_event_handler() queues the buttons newly pressed on pad 1, with the
+// frame (vtimer) of the event. The handler only moves joy_queue_head and
+// the VM only joy_queue_tail, so no lock is needed. When the queue is
+// full, new events are dropped.
+#define JOY_QUEUE_SIZE 16	// power of 2
+
+static volatile struct JOY_EVENT {
+  u16 pressed;
+  u32 frame;
+} joy_queue[JOY_QUEUE_SIZE];
+static volatile u8 joy_queue_head;
+static volatile u8 joy_queue_tail;
+
+static void joy_push(u16 pressed) {
+  u8 next = (joy_queue_head + 1) & (JOY_QUEUE_SIZE - 1);
+  if(next == joy_queue_tail) return;
+
+  joy_queue[joy_queue_head].pressed = pressed;
+  joy_queue[joy_queue_head].frame = vtimer;
+  joy_queue_head = next;
+}
+
+// takes the oldest event. returns its buttons, or 0 if there is none.
+static u16 joy_pop() {
+  if(joy_queue_tail == joy_queue_head) return 0;
+
+  volatile struct JOY_EVENT *event = &joy_queue[joy_queue_tail];
+  u16 pressed = event->pressed;
+  u32 lag = vtimer - event->frame;
+  if(lag > frame_stats.input_lag) frame_stats.input_lag = (lag > 0xffff) ? 0xffff : lag;
+
+  joy_queue_tail = (joy_queue_tail + 1) & (JOY_QUEUE_SIZE - 1);
+  return pressed;
+}
+
+// The task waiting in wait_input(), one at a time: a press goes to one
+// task. It is suspended, and resumed by input_wake() after a frame with a
+// press or its timeout.
+static struct INPUT_WAITER {
+  mrbc_tcb *tcb;	// NULL: none
+  mrbc_value *ret;	// return value of wait_input()
+  bool forever;
+  u32 deadline;		// vtimer
+} input_waiter;
+
+static void input_wake() {
+  if(!input_waiter.tcb) return;
+
+  u16 pressed = joy_pop();
+  if(!pressed && (input_waiter.forever || (s32)(vtimer - input_waiter.deadline) < 0)) return;
+
+  mrbc_set_integer(input_waiter.ret, pressed);
+  mrbc_resume_task(input_waiter.tcb);
+  input_waiter.tcb = NULL;
+}
+
+// MegaMrbc.wait_input(timeout = nil)
+// Waits for up to timeout frames (without timeout, until a button is
+// pressed) and returns the buttons of the next press on pad 1, or 0.
+// wait_input(0) only polls. The task is suspended while waiting, so an
+// idle VM interprets nothing. Raises if another task is waiting.
+static void c_megamrbc_wait_input(mrb_vm *vm, mrb_value *v, int argc) {
+  bool forever = argc < 1 || mrbc_type(v[1]) != MRBC_TT_INTEGER;
+  mrbc_int timeout = forever ? 0 : mrbc_integer(v[1]);
+  u16 pressed = joy_pop();
+
+  SET_INT_RETURN(pressed);
+  if(pressed || (!forever && timeout <= 0)) return;
+
+  if(input_waiter.tcb) {
+    mrbc_raise(vm, MRBC_CLASS(RuntimeError), "another task is waiting for input");
+    return;
+  }
+  input_waiter.tcb = task_of(vm);
+  if(!input_waiter.tcb) return;
+  input_waiter.ret = v;
+  input_waiter.forever = forever;
+  input_waiter.deadline = vtimer + timeout;
+  mrbc_suspend_task(input_waiter.tcb);
+}
+
 static void c_megamrbc_scroll_title(mrb_vm *vm, mrb_value *v, int argc) {
   static int offset_b = 0;
   static uint8_t scrollspeed_b = 1;
@@ -520,173 +1206,121 @@ static void c_megamrbc_scroll_game(mrb_vm *vm, mrb_value *v, int argc) {
   VDP_setHorizontalScroll(BG_A, offset_a -= scrollspeed_a);
 }
 
-static bool name_match(const char* str0, const char* str1) {
-  // TODO: check the lengths and use longer one with strncmp
-  return strcmp(str0, str1) == 0;
+#include "_autogen_image_table.h"
+
+// Finds the image by name with binary search, same as the symbol table.
+// The name is len bytes, not necessarily terminated (a string may be a view).
+// Returns the index in image_table, or -1 if not found.
+static int search_image_table(const char *img_name, int len) {
+  int left = 0;
+  int right = IMAGE_TABLE_SIZE;
+
+  while(left < right) {
+    int mid = (left + right) / 2;
+    const unsigned char *p1 = (const unsigned char *)image_table[mid].name;
+    const unsigned char *p2 = (const unsigned char *)img_name;
+    int n = len;
+
+    while(n > 0 && *p1 == *p2 && *p1) {
+      p1++;
+      p2++;
+      n--;
+    }
+    int ch2 = (n > 0) ? *p2 : 0;
+    if(*p1 == ch2) return mid;
+    if(*p1 < ch2) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+
+  return -1;
+}
+
+static const Image *find_image(const char *img_name, int len) {
+  int idx = search_image_table(img_name, len);
+  return (idx < 0) ? NULL : image_table[idx].image;
+}
+
+// stream: the tiles come in over the next frames, see stream_cached_image.
+static void draw_image_at(const Image *image, uint8_t x, uint8_t y, bool stream) {
+  if(!image) return;
+
+  PAL_setPaletteDMA(PAL3, image->palette->data);
+  if(stream) {
+    stream_cached_image(BG_A, image, PAL3, x, y);
+  } else {
+    draw_cached_image(BG_A, image, PAL3, x, y);
+  }
 }
 
+// draw_image(x, y, image) image is a name (String or Symbol) or an ID
+// MegaMrbc.draw_image(x, y, image, stream = false)
 static void c_megamrbc_draw_image(mrb_vm *vm, mrb_value *v, int argc) {
   uint8_t x = mrbc_integer(v[1]);
   uint8_t y = mrbc_integer(v[2]);
-  char *img_name = mrbc_string_cstr(&v[3]);
-
-  char buf[40];
-  VDP_drawText(buf, 2, 3);
-
-  Image *image;
-
-  // TODO: some sort of auto mapping here would be great...
-  if(name_match(img_name, "adl_bkk")) {
-    image = &adl_bkk;
-  } else if(name_match(img_name, "adl_bkk_br")) {
-    image = &adl_bkk_br;
-  } else if(name_match(img_name, "yuji")) {
-    image = &yuji;
-  } else if(name_match(img_name, "yuji_br")) {
-    image = &yuji_br;
-  } else if(name_match(img_name, "ruby")) {
-    image = &ruby;
-  } else if(name_match(img_name, "rubykaigi")) {
-    image = &rubykaigi;
-  } else if(name_match(img_name, "mrubykaigi")) {
-    image = &mrubykaigi;
-  } else if(name_match(img_name, "rubyconfth")) {
-    image = &rubyconfth;
-  } else if(name_match(img_name, "c_klog")) {
-    image = &c_klog;
-  } else if(name_match(img_name, "define_ruby_methods")) {
-    image = &define_ruby_methods;
-  } else if(name_match(img_name, "calling_from_ruby")) {
-    image = &calling_from_ruby;
-  } else if(name_match(img_name, "d000")) {
-    image = &dev_proc_000;
-  } else if(name_match(img_name, "d001")) {
-    image = &dev_proc_001;
-  } else if(name_match(img_name, "d002")) {
-    image = &dev_proc_002;
-  } else if(name_match(img_name, "d003")) {
-    image = &dev_proc_003;
-  } else if(name_match(img_name, "d004")) {
-    image = &dev_proc_004;
-  } else if(name_match(img_name, "d005")) {
-    image = &dev_proc_005;
-  } else if(name_match(img_name, "d006")) {
-    image = &dev_proc_006;
-  } else if(name_match(img_name, "d007")) {
-    image = &dev_proc_007;
-  } else if(name_match(img_name, "d008")) {
-    image = &dev_proc_008;
-  } else if(name_match(img_name, "m000")) {
-    image = &dev_w_mrubyc_000;
-  } else if(name_match(img_name, "m001")) {
-    image = &dev_w_mrubyc_001;
-  } else if(name_match(img_name, "m002")) {
-    image = &dev_w_mrubyc_002;
-  } else if(name_match(img_name, "m003")) {
-    image = &dev_w_mrubyc_003;
-  } else if(name_match(img_name, "m004")) {
-    image = &dev_w_mrubyc_004;
-  } else if(name_match(img_name, "m005")) {
-    image = &dev_w_mrubyc_005;
-  } else if(name_match(img_name, "m006")) {
-    image = &dev_w_mrubyc_006;
-  } else if(name_match(img_name, "m007")) {
-    image = &dev_w_mrubyc_007;
-  } else if(name_match(img_name, "m008")) {
-    image = &dev_w_mrubyc_008;
-  } else if(name_match(img_name, "m009")) {
-    image = &dev_w_mrubyc_009;
-  } else if(name_match(img_name, "m010")) {
-    image = &dev_w_mrubyc_010;
-  } else if(name_match(img_name, "m011")) {
-    image = &dev_w_mrubyc_011;
-  } else if(name_match(img_name, "m012")) {
-    image = &dev_w_mrubyc_012;
-  } else if(name_match(img_name, "ru000")) {
-    image = &resource_usage000;
-  } else if(name_match(img_name, "ru001")) {
-    image = &resource_usage001;
-  } else if(name_match(img_name, "ru002")) {
-    image = &resource_usage002;
-  } else if(name_match(img_name, "ru003")) {
-    image = &resource_usage003;
-  } else if(name_match(img_name, "ru004")) {
-    image = &resource_usage004;
-  } else if(name_match(img_name, "aboutme")) {
-    image = &aboutme;
-  } else if(name_match(img_name, "whatsmd")) {
-    image = &whatsmd;
-  } else if(name_match(img_name, "whatsmruby")) {
-    image = &whatsmruby;
-  } else if(name_match(img_name, "whatsmrubyc")) {
-    image = &whatsmrubyc;
-  } else if(name_match(img_name, "whymd")) {
-    image = &whymd;
-  } else if(name_match(img_name, "whymrubyconmd")) {
-    image = &whymrubyconmd;
-  } else if(name_match(img_name, "SGDK")) {
-    image = &SGDK;
-  } else if(name_match(img_name, "mdgraphic")) {
-    image = &mdgraphic;
-  } else if(name_match(img_name, "mdchallenges")) {
-    image = &mdchallenges;
-  } else if(name_match(img_name, "emulators")) {
-    image = &emulators;
-  } else if(name_match(img_name, "mainloop")) {
-    image = &mainloop;
-  } else if(name_match(img_name, "sgdkmrbc")) {
-    image = &sgdkmrbc;
-  } else if(name_match(img_name, "cipherstash")) {
-    image = &cipherstash;
-  } else if(name_match(img_name, "rubyconfau")) {
-    image = &rubyconfau;
-  } else if(name_match(img_name, "mrbld_000")) {
-    image = &mrubyloading_000;
-  } else if(name_match(img_name, "mrbld_001")) {
-    image = &mrubyloading_001;
-  } else if(name_match(img_name, "mrbld_002")) {
-    image = &mrubyloading_002;
-  } else if(name_match(img_name, "mrbld_003")) {
-    image = &mrubyloading_003;
-  } else if(name_match(img_name, "mrbld_004")) {
-    image = &mrubyloading_004;
-  } else if(name_match(img_name, "adl_mel")) {
-    image = &adl_mel;
-  } else if(name_match(img_name, "adl_mel_br")) {
-    image = &adl_mel_br;
-  } else if(name_match(img_name, "slide_ex000")) {
-    image = &slide_ex000;
-  } else if(name_match(img_name, "slide_ex001")) {
-    image = &slide_ex001;
-  } else if(name_match(img_name, "slide_ex002")) {
-    image = &slide_ex002;
+  const Image *image = NULL;
+
+  switch(mrbc_type(v[3])) {
+  case MRBC_TT_INTEGER:
+    if(mrbc_integer(v[3]) >= 0 && mrbc_integer(v[3]) < IMAGE_TABLE_SIZE) {
+      image = image_table[mrbc_integer(v[3])].image;
+    }
+    break;
+
+  case MRBC_TT_SYMBOL:
+    image = find_image(mrbc_symbol_cstr(&v[3]), strlen(mrbc_symbol_cstr(&v[3])));
+    break;
+
+  case MRBC_TT_STRING:
+    image = find_image(mrbc_string_ptr(&v[3]), mrbc_string_size(&v[3]));
+    break;
+
+  default:
+    break;
   }
 
-  PAL_setPaletteDMA(PAL3, image->palette->data);
-  VDP_drawImageEx(
-    BG_A, image,
-    TILE_ATTR_FULL(PAL3, FALSE, FALSE, FALSE, TILE_USERINDEX + last + 1),
-    x, y, FALSE, TRUE
-  );
+  bool stream = argc >= 4 && mrbc_type(v[4]) != MRBC_TT_NIL && mrbc_type(v[4]) != MRBC_TT_FALSE;
+  draw_image_at(image, x, y, stream);
+}
+
+// true if all streamed images are on the screen.
+static void c_megamrbc_images_ready(mrb_vm *vm, mrb_value *v, int argc) {
+  SET_BOOL_RETURN(stream_count == 0);
+}
+
+// returns the image ID for draw_image, or nil if not found
+static void c_megamrbc_image_id(mrb_vm *vm, mrb_value *v, int argc) {
+  int idx = -1;
+
+  if(mrbc_type(v[1]) == MRBC_TT_SYMBOL) {
+    idx = search_image_table(mrbc_symbol_cstr(&v[1]), strlen(mrbc_symbol_cstr(&v[1])));
+  } else if(mrbc_type(v[1]) == MRBC_TT_STRING) {
+    idx = search_image_table(mrbc_string_ptr(&v[1]), mrbc_string_size(&v[1]));
+  }
+
+  if(idx < 0) {
+    SET_NIL_RETURN();
+    return;
+  }
+  SET_INT_RETURN(idx);
 }
 
 static void c_megamrbc_draw_bg(mrb_vm *vm, mrb_value *v, int argc) {
-  char *str = mrbc_string_cstr(&v[1]);
   char bgpal_num = mrbc_integer(v[2]);
   char x = mrbc_integer(v[3]);
   char y = mrbc_integer(v[4]);
-  int len = strlen(str);
 
   // do loop for str len
-  for(int i = 0; i < len; i++) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bgpal_num, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgfull), x + i, y);
-  }
+  draw_bg_n(mrbc_string_size(&v[1]), bgpal_num, x, y);
 }
 
 static void c_megamrbc_klog(mrb_vm *vm, mrb_value *v, int argc) {
-  char *str = mrbc_string_cstr(&v[1]);
+  char buf[64];
+  const char *str = mrbc_string_cstr_buf(&v[1], buf, sizeof(buf));
 
-  KLog(str);
+  if(str) KLog(str);
 }
 
 static void c_megamrbc_show_progress(mrb_vm *vm, mrb_value *v, int argc) {
@@ -724,49 +1358,43 @@ static void c_megamrbc_hide_progress(mrb_vm *vm, mrb_value *v, int argc) {
   SPR_setVisibility(wombat1_obj, HIDDEN);
 }
 
-// sleep, but time is specificed in 1/300s
+// sleep, but time is specificed in 1/300s. the other tasks keep running.
 static void c_megamrbc_sleep(mrb_vm *vm, mrb_value *v, int argc) {
-  int s = mrbc_integer(v[1]);
-  int start = getTick();
-
-  // FIXME: wrap-around not supported
-  while( getTick() - start < s) {
-    SYS_doVBlankProcess();
-  }
+  task_sleep_frames(vm, ticks_to_frames(mrbc_integer(v[1])));
 }
 
 static void c_megamrbc_set_bg_colour(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
   char bg_pal = mrbc_integer(v[3]);
-  char *bg_region = mrbc_symbol_cstr(&v[4]);
+  const char *bg_region = mrbc_symbol_cstr(&v[4]);
 
   // TODO: improve readability
   if(strncmp(bg_region, "bottom", sizeof("bottom")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgt), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgt), x, y);
   } else if(strncmp(bg_region, "top", sizeof("top")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgt), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgt), x, y);
   } else if(strncmp(bg_region, "left", sizeof("left")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgl), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgl), x, y);
   } else if(strncmp(bg_region, "right", sizeof("right")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgl), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgl), x, y);
   } else if(strncmp(bg_region, "top_left", sizeof("top_left")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x, y);
   } else if(strncmp(bg_region, "top_right", sizeof("top_right")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgtl), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgtl), x, y);
   } else if(strncmp(bg_region, "bottom_left", sizeof("bottom_left")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x, y);
   } else if(strncmp(bg_region, "bottom_right", sizeof("bottom_right")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HFLIP, TILE_USERINDEX + bgtl), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HFLIP, TILE_USERINDEX + bgtl), x, y);
   } else if(strncmp(bg_region, "full", sizeof("full")) == 0) {
-    VDP_setTileMapXY(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgfull), x, y);
+    tm_set(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgfull), x, y);
   }
 }
 
 static void c_megamrbc_draw_arrow_r(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_USERINDEX + arwr, x, y);
+  tm_set(BG_A, TILE_USERINDEX + arwr, x, y);
 }
 
 // TODO: refactor with above
@@ -774,43 +1402,43 @@ static void c_megamrbc_draw_arrow_l(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
   // TODO: Is PAL0 okay?
-  VDP_setTileMapXY(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + arwr), x, y);
+  tm_set(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + arwr), x, y);
 }
 
 static void c_megamrbc_draw_arrow_u(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_USERINDEX + arwu, x, y);
+  tm_set(BG_A, TILE_USERINDEX + arwu, x, y);
 }
 
 static void c_megamrbc_draw_arrow_d(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + arwu), x, y);
+  tm_set(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + arwu), x, y);
 }
 
 static void c_megamrbc_draw_right_t(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_USERINDEX + trght, x, y);
+  tm_set(BG_A, TILE_USERINDEX + trght, x, y);
 }
 
 static void c_megamrbc_draw_left_t(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + trght), x, y);
+  tm_set(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + trght), x, y);
 }
 
 static void c_megamrbc_draw_upright_t(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_USERINDEX + t, x, y);
+  tm_set(BG_A, TILE_USERINDEX + t, x, y);
 }
 
 static void c_megamrbc_draw_flipped_t(mrb_vm *vm, mrb_value *v, int argc) {
   char x = mrbc_integer(v[1]);
   char y = mrbc_integer(v[2]);
-  VDP_setTileMapXY(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + t), x, y);
+  tm_set(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + t), x, y);
 }
 
 static void c_megamrbc_play_se(mrb_vm *vm, mrb_value *v, int argc) {
@@ -825,12 +1453,415 @@ static void c_megamrbc_play_death_se(mrb_vm *vm, mrb_value *v, int argc) {
   XGM_startPlayPCM(SE_DEATH,1,SOUND_PCM_CH2);
 }
 
+// returns [inline hits, inline misses, global hits, global misses] of method lookup
+static void c_megamrbc_method_cache_stats(mrb_vm *vm, mrb_value *v, int argc) {
+  struct MRBC_METHOD_CACHE_STATISTICS stats;
+  mrbc_method_cache_statistics(&stats);
+
+  mrbc_value ret = mrbc_array_new(vm, 4);
+  mrbc_array_push(&ret, &mrbc_integer_value(stats.inline_hit));
+  mrbc_array_push(&ret, &mrbc_integer_value(stats.inline_miss));
+  mrbc_array_push(&ret, &mrbc_integer_value(stats.global_hit));
+  mrbc_array_push(&ret, &mrbc_integer_value(stats.global_miss));
+  SET_RETURN(ret);
+}
+
+// returns [frames, overruns, last, worst, total, input_lag] of frame_stats.
+// last, worst and total are busy scanlines, of 262 (NTSC) or 313 (PAL)
+// per frame. input_lag is in frames.
+static void c_megamrbc_frame_stats(mrb_vm *vm, mrb_value *v, int argc) {
+  mrbc_value ret = mrbc_array_new(vm, 6);
+  mrbc_array_push(&ret, &mrbc_integer_value(frame_stats.frames));
+  mrbc_array_push(&ret, &mrbc_integer_value(frame_stats.overruns));
+  mrbc_array_push(&ret, &mrbc_integer_value(frame_stats.last));
+  mrbc_array_push(&ret, &mrbc_integer_value(frame_stats.worst));
+  mrbc_array_push(&ret, &mrbc_integer_value(frame_stats.total));
+  mrbc_array_push(&ret, &mrbc_integer_value(frame_stats.input_lag));
+  SET_RETURN(ret);
+}
+
+// MegaMrbc.frame_meter(on)
+// Shows the busy scanlines of each frame as a bar of backdrop colour.
+static void c_megamrbc_frame_meter(mrb_vm *vm, mrb_value *v, int argc) {
+  frame_meter = mrbc_type(v[1]) == MRBC_TT_TRUE;
+  VDP_setBackgroundColor(0);
+}
+
 static void c_megamrbc_set_bg_num(mrb_vm *vm, mrb_value *v, int argc) {
   char bg_num = mrbc_integer(v[1]);
   KLog("setting bg colour");
   PAL_setColor(0, bg_num);
 }
 
+// Rectangle frame on BG_A, and optional background on BG_B.
+// Same tiles as draw_top_left ... draw_bottom_right and set_bg_colour.
+static void render_rect(s16 x, s16 y, s16 w, s16 h, u8 bg_pal, bool with_bg) {
+  tm_fill(BG_A, TILE_USERINDEX + horiz, x + 1, y, w - 1, 1);
+  tm_fill(BG_A, TILE_USERINDEX + horiz, x + 1, y + h, w - 1, 1);
+  tm_fill(BG_A, TILE_USERINDEX + vert, x, y + 1, 1, h - 1);
+  tm_fill(BG_A, TILE_USERINDEX + vert, x + w, y + 1, 1, h - 1);
+
+  // corners
+  tm_put(BG_A, TILE_USERINDEX + tl, x, y);
+  tm_put(BG_A, TILE_ATTR_FULL(0,HIPRIO,VNOFLIP,HFLIP, TILE_USERINDEX + tl), x + w, y);
+  tm_put(BG_A, TILE_ATTR_FULL(0,HIPRIO,VFLIP,HNOFLIP, TILE_USERINDEX + tl), x, y + h);
+  tm_put(BG_A, TILE_ATTR_FULL(0,HIPRIO,VFLIP,HFLIP, TILE_USERINDEX + tl), x + w, y + h);
+
+  // only the frame, the inside of BG_A may hold text.
+  tm_flush(BG_A, x, y, w + 1, 1);
+  tm_flush(BG_A, x, y + h, w + 1, 1);
+  tm_flush(BG_A, x, y + 1, 1, h - 1);
+  tm_flush(BG_A, x + w, y + 1, 1, h - 1);
+
+  if(!with_bg) return;
+
+  tm_fill(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgt), x + 1, y, w - 1, 1);
+  tm_fill(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgt), x + 1, y + h, w - 1, 1);
+  tm_fill(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgl), x, y + 1, 1, h - 1);
+  tm_fill(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgfull), x + 1, y + 1, w - 1, h - 1);
+  tm_fill(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgl), x + w, y + 1, 1, h - 1);
+
+  tm_put(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x, y);
+  tm_put(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + bgtl), x + w, y);
+  tm_put(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + bgtl), x, y + h);
+  tm_put(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VFLIP, HFLIP, TILE_USERINDEX + bgtl), x + w, y + h);
+
+  tm_flush(BG_B, x, y, w + 1, h + 1);
+}
+
+// Arrow of length tiles from (x, y), optionally starting with a T junction.
+// Same tiles as draw_horizontal, draw_arrow_r ... draw_flipped_t.
+static void render_arrow(s16 x, s16 y, char direction, s16 length, bool start_t) {
+  s16 n = (length > 1) ? length - 1 : 0;   // tiles before the head
+
+  switch(direction) {
+  case 'r':
+    tm_fill(BG_A, TILE_USERINDEX + horiz, x, y, n, 1);
+    if(start_t && n > 0) tm_put(BG_A, TILE_USERINDEX + trght, x, y);
+    tm_put(BG_A, TILE_USERINDEX + arwr, x + n, y);
+    tm_flush(BG_A, x, y, n + 1, 1);
+    break;
+
+  case 'l':
+    tm_fill(BG_A, TILE_USERINDEX + horiz, x - n + 1, y, n, 1);
+    if(start_t && n > 0) tm_put(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + trght), x, y);
+    tm_put(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VNOFLIP, HFLIP, TILE_USERINDEX + arwr), x - n, y);
+    tm_flush(BG_A, x - n, y, n + 1, 1);
+    break;
+
+  case 'u':
+    tm_fill(BG_A, TILE_USERINDEX + vert, x, y - n + 1, 1, n);
+    if(start_t && n > 0) tm_put(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + t), x, y);
+    tm_put(BG_A, TILE_USERINDEX + arwu, x, y - n);
+    tm_flush(BG_A, x, y - n, 1, n + 1);
+    break;
+
+  case 'd':
+    tm_fill(BG_A, TILE_USERINDEX + vert, x, y, 1, n);
+    if(start_t && n > 0) tm_put(BG_A, TILE_USERINDEX + t, x, y);
+    tm_put(BG_A, TILE_ATTR_FULL(PAL0, LOPRIO, VFLIP, HNOFLIP, TILE_USERINDEX + arwu), x, y + n);
+    tm_flush(BG_A, x, y, 1, n + 1);
+    break;
+  }
+}
+
+// MegaMrbc.draw_code(str, x, y)
+// A line of Ruby code, syntax highlighted with text palettes 0 to 3.
+static void c_megamrbc_draw_code(mrb_vm *vm, mrb_value *v, int argc) {
+  draw_code_n(mrbc_string_ptr(&v[1]), mrbc_string_size(&v[1]), mrbc_integer(v[2]), mrbc_integer(v[3]));
+}
+
+// MegaMrbc.draw_rect(x, y, w, h, bg_pal = nil)
+// Same as -rect in the slides. Without bg_pal, only the frame is drawn.
+static void c_megamrbc_draw_rect(mrb_vm *vm, mrb_value *v, int argc) {
+  bool with_bg = argc >= 5 && mrbc_type(v[5]) == MRBC_TT_INTEGER;
+
+  render_rect(mrbc_integer(v[1]), mrbc_integer(v[2]), mrbc_integer(v[3]),
+              mrbc_integer(v[4]), with_bg ? mrbc_integer(v[5]) : 0, with_bg);
+}
+
+// MegaMrbc.fill_bg(x, y, w, h, bg_pal)
+static void c_megamrbc_fill_bg(mrb_vm *vm, mrb_value *v, int argc) {
+  s16 x = mrbc_integer(v[1]);
+  s16 y = mrbc_integer(v[2]);
+  s16 w = mrbc_integer(v[3]);
+  s16 h = mrbc_integer(v[4]);
+  u8 bg_pal = mrbc_integer(v[5]);
+
+  tm_fill(BG_B, TILE_ATTR_FULL(bg_pal, LOPRIO, VNOFLIP, HNOFLIP, TILE_USERINDEX + bgfull), x, y, w, h);
+  tm_flush(BG_B, x, y, w, h);
+}
+
+// MegaMrbc.draw_arrow(x, y, direction, length, tee = false)
+// direction is :r, :l, :u or :d (or :right, :left, :up, :down).
+static void c_megamrbc_draw_arrow(mrb_vm *vm, mrb_value *v, int argc) {
+  if(mrbc_type(v[3]) != MRBC_TT_SYMBOL) return;
+  const char *direction = mrbc_symbol_cstr(&v[3]);
+  bool tee = argc >= 5 && mrbc_type(v[5]) != MRBC_TT_NIL && mrbc_type(v[5]) != MRBC_TT_FALSE;
+
+  render_arrow(mrbc_integer(v[1]), mrbc_integer(v[2]), direction[0], mrbc_integer(v[4]), tee);
+}
+
+// MegaMrbc.draw_text_bg(str, x, y, bg_pal)
+// Text with its background in two rectangle writes. Same as -txt,x,y,bgN
+static void c_megamrbc_draw_text_bg(mrb_vm *vm, mrb_value *v, int argc) {
+  char x = mrbc_integer(v[2]);
+  char y = mrbc_integer(v[3]);
+  char bg_pal = mrbc_integer(v[4]);
+  int len = mrbc_string_size(&v[1]);
+
+  draw_bg_n(len, bg_pal, x, y);
+  draw_text_n(mrbc_string_ptr(&v[1]), len, x, y);
+}
+
+// Display list interpreter. The slides are compiled by
+// support/compile_slides.rb, see display_list.h for the format.
+static const u8 *slide_pc = NULL;
+
+// symbol names of enum SLIDE_EVENT, returned to Ruby.
+static const char * const slide_event_names[SL_EV_NUM] = {
+  "pause", "show_timer", "hide_timer", "title_screen",
+  "demo_game", "scroll", "init_progress", "reset_timer",
+};
+
+// not an event of the slides. the task sleeps for SL_SLEEP, and Ruby gets
+// :sleep, only to resume.
+#define SL_EV_SLEEP SL_EV_NUM
+static u16 slide_sleep;	// ticks
+
+static u16 sl_read_u16(const u8 *p) {
+  return (p[0] << 8) | p[1];
+}
+
+static u32 sl_read_u32(const u8 *p) {
+  return ((u32)sl_read_u16(p) << 16) | sl_read_u16(p + 2);
+}
+
+static u16 slide_page_count() {
+  if(strncmp((const char *)slides, SL_MAGIC, 4) != 0) return 0;
+  return sl_read_u16(slides + 4);
+}
+
+static const u8 *slide_page_top(mrbc_int idx) {
+  if(idx < 0 || idx >= slide_page_count()) return NULL;
+  return slides + sl_read_u32(slides + SL_HEADER_SIZE + idx * 4);
+}
+
+// ops that only change the tilemaps or the colours, and can be run off-screen.
+static bool sl_is_offscreen_op(u8 op) {
+  switch(op) {
+  case SL_TEXT:
+  case SL_TEXT_BG:
+  case SL_TXTPAL:
+  case SL_SETCOLOUR:
+  case SL_BGCOL:
+  case SL_RECT:
+  case SL_ARROW:
+    return TRUE;
+  }
+  return FALSE;
+}
+
+// Runs the display list from *pc until the end of the page or an event
+// for Ruby. Returns the event, or -1 at the end of the page.
+// When pre-rendering, it stops before the first op that can't be run
+// off-screen, and returns -1.
+static int run_display_list(const u8 **pc, bool prerender) {
+  while(*pc) {
+    const u8 *p = *pc;
+
+    if(prerender && !sl_is_offscreen_op(*p)) return -1;
+
+    switch(*p++) {
+    case SL_TEXT:       // x, y, STR
+      draw_text_n((const char *)p + 3, p[2], p[0], p[1]);
+      p += 3 + p[2];
+      break;
+
+    case SL_TEXT_BG:    // x, y, pal, STR
+      draw_bg_n(p[3], p[2], p[0], p[1]);
+      draw_text_n((const char *)p + 4, p[3], p[0], p[1]);
+      p += 4 + p[3];
+      break;
+
+    case SL_TXTPAL:     // pal
+      set_text_palette(*p++);
+      break;
+
+    case SL_SETCOLOUR:  // index, u16 colour
+      if(!set_colour(p[0], sl_read_u16(p + 1))) return -1;
+      p += 3;
+      break;
+
+    case SL_BGCOL:      // u16 colour
+      if(!set_colour(0, sl_read_u16(p))) return -1;
+      p += 2;
+      break;
+
+    case SL_IMG:        // x, y, STR
+      draw_image_at(find_image((const char *)p + 3, p[2]), p[0], p[1], TRUE);
+      p += 3 + p[2];
+      break;
+
+    case SL_RECT:       // x, y, w, h, pal
+      render_rect(p[0], p[1], p[2], p[3], p[4], p[4] != 0xff);
+      p += 5;
+      break;
+
+    case SL_ARROW:      // x, y, direction, length, tee
+      render_arrow(p[0], p[1], p[2], p[3], p[4]);
+      p += 5;
+      break;
+
+    case SL_SLEEP:      // u16 ticks
+      slide_sleep = sl_read_u16(p);
+      *pc = p + 2;
+      return SL_EV_SLEEP;
+
+    case SL_PLAYSOUND:
+      XGM_startPlayPCM(SE_TEST,1,SOUND_PCM_CH2);
+      break;
+
+    case SL_RENDERBG:
+      show_game_bg();
+      break;
+
+    case SL_EVENT:      // event
+      *pc = p + 1;
+      return *p;
+
+    case SL_END:
+    default:
+      *pc = NULL;
+      return -1;
+    }
+
+    *pc = p;
+  }
+
+  return -1;
+}
+
+// Page pre-rendered into tm_offscreen, or -1.
+// pre_pc is where the page continues after the flip.
+static mrbc_int pre_page = -1;
+static const u8 *pre_pc = NULL;
+
+// Draws the first part of page idx off-screen, up to the first image,
+// sleep, sound, event or the end of the page.
+// Returns false if nothing could be drawn.
+static bool prerender_page(mrbc_int idx) {
+  if(idx == pre_page) return TRUE;
+
+  pre_page = -1;
+  const u8 *pc = slide_page_top(idx);
+  if(!pc) return FALSE;
+
+  // a cleared page. tile 0 is blank.
+  memset(&tm_offscreen, 0, sizeof(tm_offscreen));
+  tm_target = &tm_offscreen;
+  run_display_list(&pc, TRUE);
+  tm_target = &tm_screen;
+
+  if(tm_offscreen.dirty_a.x0 >= tm_offscreen.dirty_a.x1 &&
+     tm_offscreen.dirty_b.x0 >= tm_offscreen.dirty_b.x1) return FALSE;
+
+  pre_page = idx;
+  pre_pc = pc;
+  return TRUE;
+}
+
+// True from flip_page() until flip_finish().
+static bool flip_pending = FALSE;
+
+// Shows the pre-rendered page instead of clearing the screen.
+// Both planes are sent by DMA in the next vblank of the scheduler, and
+// flip_finish() sets the colours after it.
+static void flip_page() {
+  // leftovers outside of the visible area, e.g. wide images.
+  // not visible, so cleared right now.
+  if(tm_screen.dirty_b.x0 < 0 || tm_screen.dirty_b.y0 < 0 ||
+     tm_screen.dirty_b.x1 > TM_WIDTH || tm_screen.dirty_b.y1 > TM_HEIGHT) {
+    VDP_fillTileMapRect(BG_B, 0, TM_WIDTH, 0, TM_PLANE_WIDTH - TM_WIDTH, TM_PLANE_HEIGHT);
+    VDP_fillTileMapRect(BG_B, 0, 0, TM_HEIGHT, TM_WIDTH, TM_PLANE_HEIGHT - TM_HEIGHT);
+  }
+  if(tm_screen.dirty_a.x0 < 0 || tm_screen.dirty_a.y0 < 0 ||
+     tm_screen.dirty_a.x1 > TM_WIDTH || tm_screen.dirty_a.y1 > TM_HEIGHT) {
+    VDP_fillTileMapRect(BG_A, 0, TM_WIDTH, 0, TM_PLANE_WIDTH - TM_WIDTH, TM_PLANE_HEIGHT);
+    VDP_fillTileMapRect(BG_A, 0, 0, TM_HEIGHT, TM_WIDTH, TM_PLANE_HEIGHT - TM_HEIGHT);
+  }
+
+  memcpy(tm_screen.plane_a, tm_offscreen.plane_a, sizeof(tm_screen.plane_a));
+  memcpy(tm_screen.plane_b, tm_offscreen.plane_b, sizeof(tm_screen.plane_b));
+  tm_screen.dirty_a = tm_offscreen.dirty_a;
+  tm_screen.dirty_b = tm_offscreen.dirty_b;
+
+  VDP_setTileMapDataRect(BG_B, tm_screen.plane_b[0], 0, 0, TM_WIDTH, TM_HEIGHT, TM_WIDTH, DMA_QUEUE);
+  VDP_setTileMapDataRect(BG_A, tm_screen.plane_a[0], 0, 0, TM_WIDTH, TM_HEIGHT, TM_WIDTH, DMA_QUEUE);
+
+  // no streamed image of the old page is drawn in that vblank.
+  image_cache_new_page();
+  pre_page = -1;
+  flip_pending = TRUE;
+}
+
+// Called after the vblank: the flipped page is on the planes, so its
+// colours are set now. tm_offscreen is kept until the next prerender.
+static void flip_finish() {
+  if(!flip_pending) return;
+  flip_pending = FALSE;
+
+  reset_page_state();
+  VDP_setTextPalette(tm_offscreen.txtpal);
+  for(u8 i = 0; i < tm_offscreen.num_colours; i++) {
+    PAL_setColor(tm_offscreen.colours[i].index, tm_offscreen.colours[i].colour);
+  }
+}
+
+// Continues rendering the current page.
+// Returns the next event symbol for Ruby, or nil at the end of the page.
+static void c_megamrbc_render_resume(mrb_vm *vm, mrb_value *v, int argc) {
+  int event = run_display_list(&slide_pc, FALSE);
+
+  if(event == SL_EV_SLEEP) {
+    task_sleep_frames(vm, ticks_to_frames(slide_sleep));
+    SET_RETURN(mrbc_symbol_value(mrbc_str_to_symid("sleep")));
+    return;
+  }
+  if(event < 0 || event >= SL_EV_NUM) {
+    SET_NIL_RETURN();
+    return;
+  }
+
+  SET_RETURN(mrbc_symbol_value(mrbc_str_to_symid(slide_event_names[event])));
+}
+
+// Clears the screen and starts rendering page idx, or flips in the page
+// if it has been pre-rendered. Returns the same as render_resume.
+// A flip returns :sleep: the page goes on after the vblank that sends it.
+static void c_megamrbc_render_page(mrb_vm *vm, mrb_value *v, int argc) {
+  mrbc_int idx = mrbc_integer(v[1]);
+
+  if(idx == pre_page) {
+    flip_page();
+    slide_pc = pre_pc;
+    task_sleep_frames(vm, 1);
+    SET_RETURN(mrbc_symbol_value(mrbc_str_to_symid("sleep")));
+    return;
+  }
+
+  clear_screen();
+  slide_pc = slide_page_top(idx);
+
+  c_megamrbc_render_resume(vm, v, argc);
+}
+
+// Pre-renders page idx off-screen while waiting for the joypad, so that
+// the next render_page(idx) is a flip. Returns true if it is ready.
+static void c_megamrbc_prerender_page(mrb_vm *vm, mrb_value *v, int argc) {
+  SET_BOOL_RETURN(prerender_page(mrbc_integer(v[1])));
+}
+
 void make_class(mrb_vm *vm)
 {
   mrb_class *cls = mrbc_define_class(vm, "MegaMrbc", mrbc_class_object);
@@ -842,6 +1873,7 @@ void make_class(mrb_vm *vm)
   mrbc_define_method(vm, cls, "draw_bottom_left", c_megamrbc_draw_bottom_left);
   mrbc_define_method(vm, cls, "draw_bottom_right", c_megamrbc_draw_bottom_right);
   mrbc_define_method(vm, cls, "read_joypad", c_megamrbc_read_joypad);
+  mrbc_define_method(vm, cls, "wait_input", c_megamrbc_wait_input);
   mrbc_define_method(vm, cls, "wait_vblank", c_megamrbc_wait_vblank);
   mrbc_define_method(vm, cls, "show_tick", c_megamrbc_show_tick);
   mrbc_define_method(vm, cls, "clear_screen", c_megamrbc_clear_screen);
@@ -859,13 +1891,23 @@ void make_class(mrb_vm *vm)
   // Maybe not needed???
   mrbc_define_method(vm, cls, "read_page_at", c_megamrbc_read_page_at);
   mrbc_define_method(vm, cls, "page_count", c_megamrbc_page_count);
+  mrbc_define_method(vm, cls, "render_page", c_megamrbc_render_page);
+  mrbc_define_method(vm, cls, "render_resume", c_megamrbc_render_resume);
+  mrbc_define_method(vm, cls, "prerender_page", c_megamrbc_prerender_page);
   mrbc_define_method(vm, cls, "set_pal_colour", c_megamrbc_set_pal_colour);
   mrbc_define_method(vm, cls, "set_txt_pal", c_megamrbc_set_txt_pal);
   mrbc_define_method(vm, cls, "scroll_title", c_megamrbc_scroll_title);
   mrbc_define_method(vm, cls, "scroll_weird", c_megamrbc_scroll_weird);
   mrbc_define_method(vm, cls, "scroll_game", c_megamrbc_scroll_game);
   mrbc_define_method(vm, cls, "draw_image", c_megamrbc_draw_image);
+  mrbc_define_method(vm, cls, "image_id", c_megamrbc_image_id);
+  mrbc_define_method(vm, cls, "images_ready?", c_megamrbc_images_ready);
   mrbc_define_method(vm, cls, "draw_bg", c_megamrbc_draw_bg);
+  mrbc_define_method(vm, cls, "draw_text_bg", c_megamrbc_draw_text_bg);
+  mrbc_define_method(vm, cls, "draw_code", c_megamrbc_draw_code);
+  mrbc_define_method(vm, cls, "draw_rect", c_megamrbc_draw_rect);
+  mrbc_define_method(vm, cls, "fill_bg", c_megamrbc_fill_bg);
+  mrbc_define_method(vm, cls, "draw_arrow", c_megamrbc_draw_arrow);
   mrbc_define_method(vm, cls, "klog", c_megamrbc_klog);
   mrbc_define_method(vm, cls, "show_progress", c_megamrbc_show_progress);
   mrbc_define_method(vm, cls, "show_timer", c_megamrbc_show_timer);
@@ -886,33 +1928,54 @@ void make_class(mrb_vm *vm)
   mrbc_define_method(vm, cls, "play_jump_se", c_megamrbc_play_jump_se);
   mrbc_define_method(vm, cls, "play_death_se", c_megamrbc_play_death_se);
   mrbc_define_method(vm, cls, "set_bg_num", c_megamrbc_set_bg_num);
+  mrbc_define_method(vm, cls, "method_cache_stats", c_megamrbc_method_cache_stats);
+  mrbc_define_method(vm, cls, "frame_stats", c_megamrbc_frame_stats);
+  mrbc_define_method(vm, cls, "frame_meter", c_megamrbc_frame_meter);
 }
 
-void mrubyc(const uint8_t *mrbbuf)
+// Called by the scheduler when all the tasks wait: the frame is done.
+void hal_idle_cpu(void) {
+  SPR_update();
+  vblank();
+  flip_finish();
+  input_wake();
+}
+
+extern const uint8_t mrbsrc[];			// src/game.rb
+extern const uint8_t mrbsrc_animation[];	// src/animation.rb
+extern const uint8_t mrbsrc_overlay[];		// src/overlay.rb
+
+// The presentation, the background animations and the timer overlay run
+// as tasks. In a frame, the tasks of higher priority (smaller number) run
+// first, and the presentation gets the rest of the frame.
+static const struct APP_TASK {
+  const uint8_t *bytecode;
+  uint8_t priority;
+} app_tasks[] = {
+  { mrbsrc_overlay, 64 },
+  { mrbsrc_animation, 96 },
+  { mrbsrc, 128 },
+};
+#define APP_TASK_COUNT (sizeof(app_tasks) / sizeof(app_tasks[0]))
+
+static mrbc_tcb app_tcbs[APP_TASK_COUNT];
+
+void mrubyc(void)
 {
-  mrbc_init_global();
-  mrbc_init_class();
+  mrbc_init(NULL, 0);
+  make_class(NULL);
 
-  mrbc_vm *vm = mrbc_vm_open(NULL);
-  if( vm == 0 ) {
-    return;
+  for(u8 i = 0; i < APP_TASK_COUNT; i++) {
+    mrbc_init_tcb(&app_tcbs[i]);
+    app_tcbs[i].priority = app_tasks[i].priority;
+    if( !mrbc_create_task(app_tasks[i].bytecode, &app_tcbs[i]) ) return;
   }
 
-  if( mrbc_load_mrb(vm, mrbbuf) != 0 ) {
-    return;
-  }
-
-  mrbc_vm_begin(vm);
-
-  make_class(vm);
-
-  mrbc_vm_run(vm);
-  mrbc_vm_end(vm);
-  mrbc_vm_close(vm);
+  SYS_setVIntCallback(mrbc_tick);
+  frame_begin();
+  mrbc_run();
 }
 
-extern const uint8_t mrbsrc[];
-
 void reset_text_colours() {
   PAL_setColor(15, 0x0FFF);
   PAL_setColor(31, 0x02F2);
@@ -945,11 +2008,9 @@ void set_up_colours() {
 */
 
 static void joy_event_handler(u16 pad_num, u16 changed, u16 state) {
-  char buf[40];
-  static int count = 0;
-  // VDP_drawText(buf, 1, 18);
   if(pad_num == JOY_1) joy_pressed = changed & state;
   else joy_pressed = 0;
+  if(joy_pressed) joy_push(joy_pressed);
 }
 
 int main(void) {
@@ -964,10 +2025,9 @@ int main(void) {
 
   // set_up_colours();
   load_tiles();
+  build_page_index();
 
-  if( mrbsrc == 0 ) return 1;
-
-  mrubyc( mrbsrc );
+  mrubyc();
 
   return 0;
 }
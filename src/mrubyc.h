@@ -26,6 +26,7 @@
 #include "class.h"
 #include "c_math.h"
 #include "c_array.h"
+#include "c_fiber.h"
 #include "c_hash.h"
 #include "c_object.h"
 #include "c_numeric.h"
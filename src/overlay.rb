@@ -0,0 +1,16 @@
+# Timer and progress overlay. Runs as a task of its own (see mrubyc() in
+# main.c), and redraws every frame what Presentation publishes in the
+# global variables.
+shown = nil
+while true do
+  if $show_timer
+    MegaMrbc.show_progress($page_index, $start_idx.to_i, $page_count - 1) if $page_index && $page_count
+    MegaMrbc.show_timer($start_tick || 0)
+    shown = true
+  elsif shown != false
+    MegaMrbc.hide_progress
+    MegaMrbc.hide_timer
+    shown = false
+  end
+  MegaMrbc.wait_vblank
+end
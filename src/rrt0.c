@@ -0,0 +1,556 @@
+/*! @file
+  @brief
+  Realtime multitask monitor for mruby/c
+
+  <pre>
+  Copyright (C) 2015-2022 Kyushu Institute of Technology.
+  Copyright (C) 2015-2022 Shimane IT Open-Innovation Center.
+
+  This file is distributed under BSD 3-Clause License.
+
+  Tasks are switched between opcodes only, when the running task used up
+  its timeslice, a task of higher priority becomes ready, or the running
+  task sleeps, waits for a mutex or is suspended.
+  mrbc_tick() must be called by the timer interrupt of the HAL. On the
+  Mega Drive it is the vertical interrupt, so that a tick is a frame.
+  </pre>
+*/
+
+/***** Feature test switches ************************************************/
+/***** System headers *******************************************************/
+//@cond
+#include "vm_config.h"
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+//@endcond
+
+/***** Local headers ********************************************************/
+#include "alloc.h"
+#include "global.h"
+#include "symbol.h"
+#include "class.h"
+#include "error.h"
+#include "load.h"
+#include "console.h"
+#include "vm.h"
+#include "rrt0.h"
+#include "hal_selector.h"
+
+
+/***** Constant values ******************************************************/
+#if !defined(MRBC_TICK_UNIT)
+#define MRBC_TICK_UNIT 1		//!< ms per tick.
+#endif
+
+#if !defined(MRBC_TIMESLICE_TICK_COUNT)
+#define MRBC_TIMESLICE_TICK_COUNT 10	//!< ticks per timeslice.
+#endif
+
+#define MRBC_TASK_DEFAULT_PRIORITY 128
+
+
+/***** Macros ***************************************************************/
+/***** Typedefs *************************************************************/
+/***** Function prototypes **************************************************/
+/***** Local variables ******************************************************/
+static mrbc_tcb *q_dormant_;
+static mrbc_tcb *q_ready_;
+static mrbc_tcb *q_waiting_;
+static mrbc_tcb *q_suspended_;
+static volatile uint32_t tick_;
+
+
+/***** Global variables *****************************************************/
+/***** Signal catching functions ********************************************/
+/***** Local functions ******************************************************/
+
+//================================================================
+/*! get the task queue of the state.
+
+  @param  state	task state.
+  @return	pointer to the queue head.
+*/
+static mrbc_tcb ** task_queue( uint8_t state )
+{
+  switch( state ) {
+  case TASKSTATE_DORMANT:	return &q_dormant_;
+  case TASKSTATE_READY:
+  case TASKSTATE_RUNNING:	return &q_ready_;
+  case TASKSTATE_WAITING:	return &q_waiting_;
+  case TASKSTATE_SUSPENDED:	return &q_suspended_;
+  }
+
+  assert(!"Wrong task state.");
+  return &q_dormant_;
+}
+
+
+//================================================================
+/*! insert a task to the queue of its state.
+
+  The queues are sorted by priority (smaller is higher). A task goes
+  after the tasks of the same priority, for round robin.
+
+  @param  tcb	target task.
+*/
+static void q_insert_task( mrbc_tcb *tcb )
+{
+  mrbc_tcb **pp = task_queue( tcb->state );
+
+  while( *pp && (*pp)->priority_preemption <= tcb->priority_preemption ) {
+    pp = &(*pp)->next;
+  }
+  tcb->next = *pp;
+  *pp = tcb;
+}
+
+
+//================================================================
+/*! delete a task from the queue of its state.
+
+  @param  tcb	target task.
+*/
+static void q_delete_task( mrbc_tcb *tcb )
+{
+  mrbc_tcb **pp = task_queue( tcb->state );
+
+  while( *pp ) {
+    if( *pp == tcb ) {
+      *pp = tcb->next;
+      tcb->next = NULL;
+      return;
+    }
+    pp = &(*pp)->next;
+  }
+}
+
+
+//================================================================
+/*! move a task to the queue of a new state.
+
+  Must be called with irq disabled.
+
+  @param  tcb	target task.
+  @param  state	new state.
+*/
+static void q_move_task( mrbc_tcb *tcb, uint8_t state )
+{
+  q_delete_task( tcb );
+  tcb->state = state;
+  q_insert_task( tcb );
+}
+
+
+//================================================================
+/*! preempt the running task, if a task of higher priority is ready.
+*/
+static void preempt_running_task( void )
+{
+  mrbc_tcb *tcb;
+
+  if( !q_ready_ || q_ready_->state == TASKSTATE_RUNNING ) return;
+
+  for( tcb = q_ready_; tcb; tcb = tcb->next ) {
+    if( tcb->state == TASKSTATE_RUNNING ) tcb->vm.flag_preemption = 1;
+  }
+}
+
+
+/***** Global functions *****************************************************/
+
+//================================================================
+/*! Tick timer interrupt handler.
+
+  Counts down the timeslice of the running task, and wakes up the
+  sleeping tasks.
+*/
+void mrbc_tick(void)
+{
+  mrbc_tcb *tcb;
+
+  tick_++;
+
+  // decrease the timeslice of the running task.
+  tcb = q_ready_;
+  if( tcb && tcb->state == TASKSTATE_RUNNING && tcb->timeslice > 0 ) {
+    tcb->timeslice--;
+    if( tcb->timeslice == 0 ) tcb->vm.flag_preemption = 1;
+  }
+
+  // wake up the tasks of which sleep is over.
+  tcb = q_waiting_;
+  while( tcb ) {
+    mrbc_tcb *next = tcb->next;
+
+    if( tcb->reason == TASKREASON_SLEEP &&
+	(int32_t)(tick_ - tcb->wakeup_tick) >= 0 ) {
+      q_move_task( tcb, TASKSTATE_READY );
+    }
+    tcb = next;
+  }
+
+  preempt_running_task();
+}
+
+
+//================================================================
+/*! initialize
+
+  @param  ptr	pointer to memory pool.
+  @param  size	size of the memory pool.
+  @note	On the SGDK port, the memory is allocated with malloc(), and
+	the memory pool is not used. (see alloc.c)
+*/
+void mrbc_init(uint8_t *ptr, unsigned int size)
+{
+  hal_init();
+  mrbc_init_global();
+  mrbc_init_class();
+}
+
+
+//================================================================
+/*! cleanup all internal data.
+*/
+void mrbc_cleanup(void)
+{
+  mrbc_cleanup_vm();
+  mrbc_cleanup_symbol();
+
+  q_dormant_ = NULL;
+  q_ready_ = NULL;
+  q_waiting_ = NULL;
+  q_suspended_ = NULL;
+}
+
+
+//================================================================
+/*! initialize task control block
+
+  @param  tcb	pointer to TCB.
+*/
+void mrbc_init_tcb(mrbc_tcb *tcb)
+{
+  memset( tcb, 0, sizeof(mrbc_tcb) );
+  tcb->priority = MRBC_TASK_DEFAULT_PRIORITY;
+  tcb->priority_preemption = MRBC_TASK_DEFAULT_PRIORITY;
+  tcb->state = TASKSTATE_DORMANT;
+}
+
+
+//================================================================
+/*! create a task, and make it ready to run.
+
+  @param  vm_code	pointer to bytecode.
+  @param  tcb		pointer to TCB, or NULL to allocate.
+			The priority may be set after mrbc_init_tcb().
+  @return		pointer to the TCB.
+  @retval NULL		error.
+*/
+mrbc_tcb *mrbc_create_task(const uint8_t *vm_code, mrbc_tcb *tcb)
+{
+  if( !tcb ) {
+    tcb = mrbc_raw_alloc( sizeof(mrbc_tcb) );
+    if( !tcb ) return NULL;	// ENOMEM
+    mrbc_init_tcb( tcb );
+  }
+  tcb->priority_preemption = tcb->priority;
+  tcb->timeslice = MRBC_TIMESLICE_TICK_COUNT;
+
+  if( !mrbc_vm_open( &tcb->vm ) ) {
+    mrbc_printf("Error: Can't assign VM-ID.\n");
+    return NULL;
+  }
+  mrbc_vm_set_stack( &tcb->vm, tcb->stack.regs, MAX_REGS_SIZE,
+		     tcb->stack.callinfo, MAX_CALLINFO_COUNT );
+  if( mrbc_load_mrb( &tcb->vm, vm_code ) != 0 ) {
+    mrbc_print_exception( &tcb->vm.exception );
+    mrbc_vm_close( &tcb->vm );
+    return NULL;
+  }
+  mrbc_vm_begin( &tcb->vm );
+
+  hal_disable_irq();
+  tcb->state = TASKSTATE_READY;
+  q_insert_task( tcb );
+  hal_enable_irq();
+
+  return tcb;
+}
+
+
+//================================================================
+/*! start a dormant task again.
+
+  The VM must have flag_permanence set, so that it is kept when the
+  task ends.
+
+  @param  tcb	target task.
+  @retval 0	no error.
+  @retval -1	the task is not dormant.
+*/
+int mrbc_start_task(mrbc_tcb *tcb)
+{
+  if( tcb->state != TASKSTATE_DORMANT ) return -1;
+
+  tcb->timeslice = MRBC_TIMESLICE_TICK_COUNT;
+  mrbc_vm_begin( &tcb->vm );
+
+  hal_disable_irq();
+  q_move_task( tcb, TASKSTATE_READY );
+  preempt_running_task();
+  hal_enable_irq();
+
+  return 0;
+}
+
+
+//================================================================
+/*! execute the tasks.
+
+  @retval 1	all tasks are done.
+  @retval 2	a task ended by an exception.
+*/
+int mrbc_run(void)
+{
+  int ret = 1;
+
+  while( 1 ) {
+    // take the head of the ready queue before an interrupt handler
+    // (e.g. mrbc_tick) can change it.
+    hal_disable_irq();
+    mrbc_tcb *tcb = q_ready_;
+    if( tcb ) tcb->state = TASKSTATE_RUNNING;
+    int flag_no_task = !tcb && !q_waiting_ && !q_suspended_;
+    hal_enable_irq();
+
+    if( !tcb ) {
+      // no task is ready.
+      if( flag_no_task ) break;
+      hal_idle_cpu();
+      continue;
+    }
+
+    int res = mrbc_vm_run( &tcb->vm );
+    tcb->vm.flag_preemption = 0;
+
+    if( res != 0 ) {
+      // the task is done.
+      hal_disable_irq();
+      q_move_task( tcb, TASKSTATE_DORMANT );
+      hal_enable_irq();
+      if( !tcb->vm.flag_permanence ) mrbc_vm_end( &tcb->vm );
+      if( res != 1 ) ret = res;
+      continue;
+    }
+
+    // preempted. when the timeslice is used up, round robin.
+    hal_disable_irq();
+    if( tcb->state == TASKSTATE_RUNNING ) {
+      tcb->state = TASKSTATE_READY;
+      if( tcb->timeslice == 0 ) {
+	tcb->timeslice = MRBC_TIMESLICE_TICK_COUNT;
+	q_delete_task( tcb );
+	q_insert_task( tcb );
+      }
+    }
+    hal_enable_irq();
+  }
+
+  return ret;
+}
+
+
+//================================================================
+/*! sleep the task.
+
+  The task is switched after the current opcode (i.e. the method call).
+
+  @param  tcb	target task.
+  @param  ms	time in ms. rounded up to ticks.
+*/
+void mrbc_sleep_ms(mrbc_tcb *tcb, uint32_t ms)
+{
+  hal_disable_irq();
+  q_delete_task( tcb );
+  tcb->timeslice = MRBC_TIMESLICE_TICK_COUNT;
+  tcb->state = TASKSTATE_WAITING;
+  tcb->reason = TASKREASON_SLEEP;
+  tcb->wakeup_tick = tick_ + (ms / MRBC_TICK_UNIT) + !!(ms % MRBC_TICK_UNIT);
+  q_insert_task( tcb );
+  hal_enable_irq();
+
+  tcb->vm.flag_preemption = 1;
+}
+
+
+//================================================================
+/*! give the rest of the timeslice to the tasks of the same priority.
+
+  @param  tcb	target task.
+*/
+void mrbc_relinquish(mrbc_tcb *tcb)
+{
+  tcb->timeslice = 0;
+  tcb->vm.flag_preemption = 1;
+}
+
+
+//================================================================
+/*! change the priority of the task.
+
+  @param  tcb		target task.
+  @param  priority	new priority. (smaller is higher)
+*/
+void mrbc_change_priority(mrbc_tcb *tcb, int priority)
+{
+  hal_disable_irq();
+  q_delete_task( tcb );
+  tcb->priority = priority;
+  tcb->priority_preemption = priority;
+  q_insert_task( tcb );
+  preempt_running_task();
+  hal_enable_irq();
+}
+
+
+//================================================================
+/*! suspend the task.
+
+  @param  tcb	target task.
+*/
+void mrbc_suspend_task(mrbc_tcb *tcb)
+{
+  hal_disable_irq();
+  q_move_task( tcb, TASKSTATE_SUSPENDED );
+  hal_enable_irq();
+
+  tcb->vm.flag_preemption = 1;
+}
+
+
+//================================================================
+/*! resume the suspended task.
+
+  @param  tcb	target task.
+*/
+void mrbc_resume_task(mrbc_tcb *tcb)
+{
+  hal_disable_irq();
+  if( tcb->state == TASKSTATE_SUSPENDED ) {
+    q_move_task( tcb, TASKSTATE_READY );
+    preempt_running_task();
+  }
+  hal_enable_irq();
+}
+
+
+//================================================================
+/*! initialize mutex.
+
+  @param  mutex	pointer to mutex, or NULL to allocate.
+  @return	pointer to mutex.
+  @retval NULL	error.
+*/
+mrbc_mutex *mrbc_mutex_init(mrbc_mutex *mutex)
+{
+  if( !mutex ) {
+    mutex = mrbc_raw_alloc( sizeof(mrbc_mutex) );
+    if( !mutex ) return NULL;	// ENOMEM
+  }
+  mutex->lock = 0;
+  mutex->tcb = NULL;
+
+  return mutex;
+}
+
+
+//================================================================
+/*! lock mutex. waits, if it is locked by another task.
+
+  @param  mutex	target mutex.
+  @param  tcb	task to lock.
+  @retval 0	locked, or waiting for it.
+  @retval 1	already locked by the task.
+*/
+int mrbc_mutex_lock(mrbc_mutex *mutex, mrbc_tcb *tcb)
+{
+  int ret = 0;
+
+  hal_disable_irq();
+  if( mutex->lock == 0 ) {
+    mutex->lock = 1;
+    mutex->tcb = tcb;
+  } else if( mutex->tcb == tcb ) {
+    ret = 1;
+  } else {
+    q_delete_task( tcb );
+    tcb->state = TASKSTATE_WAITING;
+    tcb->reason = TASKREASON_MUTEX;
+    tcb->mutex = mutex;
+    q_insert_task( tcb );
+    tcb->vm.flag_preemption = 1;
+  }
+  hal_enable_irq();
+
+  return ret;
+}
+
+
+//================================================================
+/*! unlock mutex. the first task waiting for it gets the lock.
+
+  @param  mutex	target mutex.
+  @param  tcb	task to unlock.
+  @retval 0	unlocked.
+  @retval 1	not locked by the task.
+*/
+int mrbc_mutex_unlock(mrbc_mutex *mutex, mrbc_tcb *tcb)
+{
+  hal_disable_irq();
+  if( mutex->lock == 0 || mutex->tcb != tcb ) {
+    hal_enable_irq();
+    return 1;
+  }
+
+  mrbc_tcb *t;
+  for( t = q_waiting_; t; t = t->next ) {
+    if( t->reason == TASKREASON_MUTEX && t->mutex == mutex ) break;
+  }
+  if( t ) {
+    mutex->tcb = t;
+    q_move_task( t, TASKSTATE_READY );
+    preempt_running_task();
+  } else {
+    mutex->lock = 0;
+    mutex->tcb = NULL;
+  }
+  hal_enable_irq();
+
+  return 0;
+}
+
+
+//================================================================
+/*! try to lock mutex. never waits.
+
+  @param  mutex	target mutex.
+  @param  tcb	task to lock.
+  @retval 0	locked.
+  @retval 1	locked by another task (or by the task itself).
+*/
+int mrbc_mutex_trylock(mrbc_mutex *mutex, mrbc_tcb *tcb)
+{
+  int ret = 1;
+
+  hal_disable_irq();
+  if( mutex->lock == 0 ) {
+    mutex->lock = 1;
+    mutex->tcb = tcb;
+    ret = 0;
+  }
+  hal_enable_irq();
+
+  return ret;
+}
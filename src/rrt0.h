@@ -17,6 +17,7 @@
 /***** System headers *******************************************************/
 //@cond
 #include <stdint.h>
+#include <stddef.h>
 //@endcond
 
 /***** Local headers ********************************************************/
@@ -46,6 +47,10 @@ enum MrbcTaskReason {
 
 
 /***** Macros ***************************************************************/
+//! TCB of the VM of a task.
+#define MRBC_VM2TCB(vm)	((mrbc_tcb *)((uint8_t *)(vm) - offsetof(mrbc_tcb, vm)))
+
+
 /***** Typedefs *************************************************************/
 
 struct RMutex;
@@ -67,6 +72,7 @@ typedef struct RTcb {
     struct RMutex *mutex;
   };
   struct VM vm;
+  mrbc_vm_stack stack;	//!< register and CALLINFO stacks of vm.
 } mrbc_tcb;
 
 
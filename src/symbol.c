@@ -30,6 +30,7 @@
 #undef MRBC_DEFINE_SYMBOL_TABLE
 #include "alloc.h"
 #include "value.h"
+#include "symbol.h"
 #include "class.h"
 #include "c_string.h"
 #include "c_array.h"
@@ -75,13 +76,14 @@ static int sym_index_pos;	// point to the last(free) sym_index array.
 /*! Calculate hash value.
 
   @param  str		Target string.
+  @param  len		Length of str.
   @return uint16_t	Hash value.
 */
-static inline uint16_t calc_hash(const char *str)
+static inline uint16_t calc_hash(const char *str, int len)
 {
   uint16_t h = 0;
 
-  while( *str != '\0' ) {
+  while( --len >= 0 ) {
     h = h * 17 + *str++;
   }
   return h;
@@ -92,9 +94,10 @@ static inline uint16_t calc_hash(const char *str)
 /*! search built-in symbol table
 
   @param  str	string ptr.
+  @param  len	length of str.
   @return	symbol id. or -1 if not found.
 */
-static int search_builtin_symbol( const char *str )
+static int search_builtin_symbol( const char *str, int len )
 {
   int left = 0;
   int right = sizeof(builtin_symbols) / sizeof(builtin_symbols[0]);
@@ -103,22 +106,29 @@ static int search_builtin_symbol( const char *str )
     int mid = (left + right) / 2;
     const unsigned char *p1 = (const unsigned char *)builtin_symbols[mid];
     const unsigned char *p2 = (const unsigned char *)str;
+    int n = len;
 
     while( 1 ) {	// string compare, same order as cruby.
-      if( *p1 < *p2 ) {
+      int ch2 = (n > 0) ? *p2 : 0;
+      if( *p1 < ch2 ) {
 	left = mid + 1;
 	break;
       }
-      if( *p1 > *p2 ) {
+      if( *p1 > ch2 ) {
 	right = mid;
 	break;
       }
       if( *p1 == 0 ) {
+	if( n > 0 ) {	// str has '\0' in it.
+	  left = mid + 1;
+	  break;
+	}
 	return mid;
       }
 
       p1++;
       p2++;
+      n--;
     }
   }
 
@@ -131,14 +141,17 @@ static int search_builtin_symbol( const char *str )
 
   @param  hash	hash value.
   @param  str	string ptr.
+  @param  len	length of str.
   @return	index. or -1 if not found.
 */
-static int search_index( uint16_t hash, const char *str )
+static int search_index( uint16_t hash, const char *str, int len )
 {
 #ifdef MRBC_SYMBOL_SEARCH_LINER
   int i;
   for( i = 0; i < sym_index_pos; i++ ) {
-    if( sym_index[i].hash == hash && strcmp(str, sym_index[i].cstr) == 0 ) {
+    if( sym_index[i].hash == hash &&
+	strncmp(str, sym_index[i].cstr, len) == 0 &&
+	sym_index[i].cstr[len] == '\0' ) {
       return i;
     }
   }
@@ -148,7 +161,9 @@ static int search_index( uint16_t hash, const char *str )
 #ifdef MRBC_SYMBOL_SEARCH_BTREE
   int i = 0;
   do {
-    if( sym_index[i].hash == hash && strcmp(str, sym_index[i].cstr) == 0 ) {
+    if( sym_index[i].hash == hash &&
+	strncmp(str, sym_index[i].cstr, len) == 0 &&
+	sym_index[i].cstr[len] == '\0' ) {
       return i;
     }
     if( hash < sym_index[i].hash ) {
@@ -225,11 +240,12 @@ void mrbc_cleanup_symbol(void)
 */
 mrbc_sym mrbc_str_to_symid(const char *str)
 {
-  mrbc_sym sym_id = search_builtin_symbol(str);
+  int len = strlen(str);
+  mrbc_sym sym_id = search_builtin_symbol(str, len);
   if( sym_id >= 0 ) return sym_id;
 
-  uint16_t h = calc_hash(str);
-  sym_id = search_index(h, str);
+  uint16_t h = calc_hash(str, len);
+  sym_id = search_index(h, str, len);
   if( sym_id < 0 ) sym_id = add_index( h, str );
   if( sym_id < 0 ) return sym_id;
 
@@ -266,11 +282,24 @@ const char * mrbc_symid_to_str(mrbc_sym sym_id)
 */
 mrbc_sym mrbc_search_symid( const char *str )
 {
-  mrbc_sym sym_id = search_builtin_symbol(str);
+  return mrbc_search_symid_n( str, strlen(str) );
+}
+
+
+//================================================================
+/*! Search only, with the length.
+
+  @param  str	string. (may not be terminated by '\0')
+  @param  len	length of str.
+  @return	symbol id. or -1 if not registered.
+*/
+mrbc_sym mrbc_search_symid_n( const char *str, int len )
+{
+  mrbc_sym sym_id = search_builtin_symbol(str, len);
   if( sym_id >= 0 ) return sym_id;
 
-  uint16_t h = calc_hash(str);
-  sym_id = search_index(h, str);
+  uint16_t h = calc_hash(str, len);
+  sym_id = search_index(h, str, len);
   if( sym_id < 0 ) return sym_id;
 
   return sym_id + OFFSET_BUILTIN_SYMBOL;
@@ -286,19 +315,33 @@ mrbc_sym mrbc_search_symid( const char *str )
 */
 mrbc_value mrbc_symbol_new(struct VM *vm, const char *str)
 {
-  mrbc_sym sym_id = mrbc_search_symid( str );
+  return mrbc_symbol_new_n( vm, str, strlen(str) );
+}
+
+
+//================================================================
+/*! constructor, with the length.
+
+  @param  vm	pointer to VM.
+  @param  str	String. (may not be terminated by '\0')
+  @param  len	length of str.
+  @return 	symbol object
+*/
+mrbc_value mrbc_symbol_new_n(struct VM *vm, const char *str, int len)
+{
+  mrbc_sym sym_id = mrbc_search_symid_n( str, len );
   if( sym_id >= 0 ) goto DONE;
 
   // create symbol object dynamically.
-  int size = strlen(str) + 1;
-  char *buf = mrbc_raw_alloc_no_free(size);
+  char *buf = mrbc_raw_alloc_no_free(len + 1);
   if( buf == NULL ) return mrbc_nil_value();	// ENOMEM raise?
 
-  memcpy(buf, str, size);
-  sym_id = add_index( calc_hash(buf), buf );
+  memcpy(buf, str, len);
+  buf[len] = '\0';
+  sym_id = add_index( calc_hash(buf, len), buf );
   if( sym_id < 0 ) {
     mrbc_raisef(vm, MRBC_CLASS(Exception),
-		"Overflow MAX_SYMBOLS_COUNT for '%s'", str );
+		"Overflow MAX_SYMBOLS_COUNT for '%s'", buf );
     return mrbc_nil_value();
   }
 
@@ -32,7 +32,9 @@ void mrbc_cleanup_symbol(void);
 mrbc_sym mrbc_str_to_symid(const char *str);
 const char *mrbc_symid_to_str(mrbc_sym sym_id);
 mrbc_sym mrbc_search_symid(const char *str);
+mrbc_sym mrbc_search_symid_n(const char *str, int len);
 mrbc_value mrbc_symbol_new(struct VM *vm, const char *str);
+mrbc_value mrbc_symbol_new_n(struct VM *vm, const char *str, int len);
 void mrbc_symbol_statistics(int *total_used);
 
 
@@ -194,25 +194,42 @@ void mrbc_clear_vm_id(mrbc_value *v)
 */
 mrbc_int mrbc_atoi( const char *s, int base )
 {
+  return mrbc_atoi_n( s, strlen(s), base );
+}
+
+
+//================================================================
+/*! convert ASCII string to integer, with the length.
+
+  @param  s	source string. (may not be terminated by '\0')
+  @param  len	length of s.
+  @param  base	n base.
+  @return	result.
+*/
+mrbc_int mrbc_atoi_n( const char *s, int len, int base )
+{
+  const char *end = s + len;
   int ret = 0;
   int sign = 0;
 
  REDO:
-  switch( *s ) {
-  case '-':
-    sign = 1;
-    // fall through.
-  case '+':
-    s++;
-    break;
+  if( s < end ) {
+    switch( *s ) {
+    case '-':
+      sign = 1;
+      // fall through.
+    case '+':
+      s++;
+      break;
 
-  case ' ':
-    s++;
-    goto REDO;
+    case ' ':
+      s++;
+      goto REDO;
+    }
   }
 
   int ch;
-  while( (ch = *s++) != '\0' ) {
+  while( s < end && (ch = *s++) != '\0' ) {
     int n;
 
     if( 'a' <= ch ) {
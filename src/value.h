@@ -314,6 +314,7 @@ extern void (* const mrbc_delfunc[])(mrbc_value *);
 int mrbc_compare(const mrbc_value *v1, const mrbc_value *v2);
 void mrbc_clear_vm_id(mrbc_value *v);
 mrbc_int mrbc_atoi(const char *s, int base);
+mrbc_int mrbc_atoi_n(const char *s, int len, int base);
 
 
 /***** Inline functions *****************************************************/
@@ -47,15 +47,170 @@
 
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
+#if MRBC_INLINE_METHOD_CACHE_SIZE > 0
+//================================================================
+/*!@brief
+  Inline method cache entry. One entry per call site (hashed).
+*/
+typedef struct INLINE_METHOD_CACHE {
+  const uint8_t *inst;		//!< call site. (instruction pointer after fetch)
+  mrbc_class *cls;		//!< receiver class.
+  uint32_t epoch;		//!< mrbc_method_epoch at cached.
+  mrbc_method method;		//!< found method.
+} mrbc_inline_method_cache;
+#endif
+
+
+#if MRBC_INLINE_IVAR_CACHE_SIZE > 0
+//================================================================
+/*!@brief
+  Inline instance variable cache entry. One entry per access site (hashed).
+*/
+typedef struct INLINE_IVAR_CACHE {
+  const uint8_t *inst;		//!< access site. (instruction pointer after fetch)
+  const mrbc_shape *shape;	//!< receiver shape.
+  mrbc_sym sym_id;		//!< ivar symbol id.
+  int16_t index;		//!< slot index.
+} mrbc_inline_ivar_cache;
+#endif
+
+
 /***** Function prototypes **************************************************/
 /***** Local variables ******************************************************/
 //! for getting the VM ID
 static uint16_t free_vm_bitmap[MAX_VM_COUNT / 16 + 1];
 
+#if MRBC_INLINE_METHOD_CACHE_SIZE > 0
+//! inline method cache.
+static mrbc_inline_method_cache inline_method_cache[MRBC_INLINE_METHOD_CACHE_SIZE];
+#endif
+
+#if MRBC_INLINE_IVAR_CACHE_SIZE > 0
+//! inline instance variable cache.
+static mrbc_inline_ivar_cache inline_ivar_cache[MRBC_INLINE_IVAR_CACHE_SIZE];
+#endif
+
 
 /***** Global variables *****************************************************/
 /***** Signal catching functions ********************************************/
 /***** Local functions ******************************************************/
+//================================================================
+/*! find method using the call site (inline) cache.
+
+  @param  vm		pointer to VM.
+  @param  r_method	pointer to mrbc_method to return values.
+  @param  cls		receiver class.
+  @param  sym_id	method name symbol id.
+  @return		pointer to method or NULL.
+*/
+static mrbc_method * find_method_by_call_site( struct VM *vm, mrbc_method *r_method, mrbc_class *cls, mrbc_sym sym_id )
+{
+#if MRBC_INLINE_METHOD_CACHE_SIZE > 0
+  mrbc_inline_method_cache *ic = &inline_method_cache[
+	((uintptr_t)vm->inst >> 1) & (MRBC_INLINE_METHOD_CACHE_SIZE - 1) ];
+
+  if( ic->inst == vm->inst && ic->cls == cls &&
+      ic->epoch == mrbc_method_epoch && ic->method.sym_id == sym_id ) {
+    mrbc_method_cache_stats.inline_hit++;
+    *r_method = ic->method;
+    return r_method;
+  }
+
+  mrbc_method_cache_stats.inline_miss++;
+  if( mrbc_find_method( r_method, cls, sym_id ) == 0 ) return 0;
+
+  ic->inst = vm->inst;
+  ic->cls = cls;
+  ic->epoch = mrbc_method_epoch;
+  ic->method = *r_method;
+  return r_method;
+
+#else
+  return mrbc_find_method( r_method, cls, sym_id );
+#endif
+}
+
+
+//================================================================
+/*! find instance variable slot using the access site (inline) cache.
+
+  @param  vm		pointer to VM.
+  @param  shape		receiver shape.
+  @param  sym_id	ivar symbol id.
+  @return		slot index or -1 (not found).
+*/
+static int find_ivar_by_access_site( struct VM *vm, const mrbc_shape *shape, mrbc_sym sym_id )
+{
+#if MRBC_INLINE_IVAR_CACHE_SIZE > 0
+  mrbc_inline_ivar_cache *ic = &inline_ivar_cache[
+	((uintptr_t)vm->inst >> 1) & (MRBC_INLINE_IVAR_CACHE_SIZE - 1) ];
+
+  if( ic->inst == vm->inst && ic->shape == shape &&
+      ic->sym_id == sym_id ) return ic->index;
+
+  int index = mrbc_shape_index( shape, sym_id );
+  if( index < 0 ) return index;
+
+  ic->inst = vm->inst;
+  ic->shape = shape;
+  ic->sym_id = sym_id;
+  ic->index = index;
+  return index;
+
+#else
+  return mrbc_shape_index( shape, sym_id );
+#endif
+}
+
+
+//================================================================
+/*! Execute attr_reader or attr_writer method inline.
+
+  @param  vm		pointer to VM.
+  @param  method	pointer to found method.
+  @param  recv		pointer to receiver and arguments.
+  @param  narg		num of arguments.
+  @retval 0		not executed. (call method->func instead)
+  @retval 1		executed.
+*/
+static int call_accessor( struct VM *vm, const mrbc_method *method, mrbc_value *recv, int narg )
+{
+  if( mrbc_type(*recv) != MRBC_TT_OBJECT ) return 0;
+  mrbc_instance *inst = recv->instance;
+  int idx;
+
+  switch( method->c_func ) {
+  case 3:	// attr_reader
+    if( narg != 0 ) return 0;
+    idx = find_ivar_by_access_site( vm, inst->shape, method->ivar_id );
+    if( idx < 0 ) {
+      mrbc_decref( recv );
+      mrbc_set_nil( recv );
+    } else {
+      mrbc_value ret = inst->ivar[idx];
+      mrbc_incref( &ret );
+      mrbc_decref( recv );
+      *recv = ret;
+    }
+    return 1;
+
+  case 4:	// attr_writer
+    if( narg != 1 ) return 0;
+    idx = find_ivar_by_access_site( vm, inst->shape, method->ivar_id );
+    if( idx < 0 ) {
+      mrbc_instance_setiv( recv, method->ivar_id, &recv[1] );
+    } else {
+      mrbc_incref( &recv[1] );
+      mrbc_decref( &inst->ivar[idx] );
+      inst->ivar[idx] = recv[1];
+    }
+    return 1;
+  }
+
+  return 0;
+}
+
+
 //================================================================
 /*! Method call by method name's id
 
@@ -113,7 +268,7 @@ static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
 
   mrbc_class *cls = find_class_by_object(recv);
   mrbc_method method;
-  if( mrbc_find_method( &method, cls, sym_id ) == 0 ) {
+  if( find_method_by_call_site( vm, &method, cls, sym_id ) == 0 ) {
     mrbc_raisef(vm, MRBC_CLASS(NoMethodError),
 		"undefined local variable or method '%s' for %s",
 		mrbc_symid_to_str(sym_id), mrbc_symid_to_str( cls->sym_id ));
@@ -122,9 +277,11 @@ static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
 
   if( method.c_func ) {
     // call C method.
-    method.func(vm, recv, narg);
-    if( sym_id == MRBC_SYM(call) ) return;
-    if( sym_id == MRBC_SYM(new) ) return;
+    if( method.c_func < 3 || !call_accessor( vm, &method, recv, narg ) ) {
+      method.func(vm, recv, narg);
+      if( sym_id == MRBC_SYM(call) ) return;
+      if( sym_id == MRBC_SYM(new) ) return;
+    }
 
     int i;
     for( i = 1; i <= narg+1; i++ ) {
@@ -134,6 +291,7 @@ static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
   } else {
     // call Ruby method.
     mrbc_callinfo *callinfo = mrbc_push_callinfo(vm, sym_id, a, narg);
+    if( !callinfo ) return;
     callinfo->own_class = method.cls;
 
     vm->cur_irep = method.irep;
@@ -181,7 +339,7 @@ static mrbc_value * mrbc_get_self( struct VM *vm, mrbc_value *regs )
     if( callinfo ) {
       self = callinfo->cur_regs + callinfo->reg_offset;
     } else {
-      self = &vm->regs[0];
+      self = &vm->top_regs[0];
     }
     assert( self->tt != MRBC_TT_PROC );
   }
@@ -233,11 +391,26 @@ const char *mrbc_get_callee_name( struct VM *vm )
 
 //================================================================
 /*! Push current status to callinfo stack
+
+  CALLINFO is taken from the stack in the VM. The slot is reused by the
+  next push as soon as it is popped, so a pointer to it (e.g. captured by
+  Proc) is valid only while the frame is active.
+
+  @param  vm		Pointer to VM
+  @param  method_id	called method ID.
+  @param  reg_offset	register offset after call.
+  @param  n_args	num of arguments.
+  @return		Pointer to pushed CALLINFO.
+  @retval NULL		stack overflow. (exception raised)
 */
 mrbc_callinfo * mrbc_push_callinfo( struct VM *vm, mrbc_sym method_id, int reg_offset, int n_args )
 {
-  mrbc_callinfo *callinfo = mrbc_alloc(vm, sizeof(mrbc_callinfo));
-  if( !callinfo ) return callinfo;
+  mrbc_callinfo *callinfo =
+    vm->callinfo_tail ? vm->callinfo_tail + 1 : vm->callinfo;
+  if( callinfo >= vm->callinfo + vm->callinfo_size ) {
+    mrbc_raise( vm, MRBC_CLASS(Exception), "MAX_CALLINFO_COUNT overflow.");
+    return NULL;
+  }
 
   callinfo->cur_irep = vm->cur_irep;
   callinfo->inst = vm->inst;
@@ -278,8 +451,6 @@ void mrbc_pop_callinfo( struct VM *vm )
   vm->cur_regs = callinfo->cur_regs;
   vm->target_class = callinfo->target_class;
   vm->callinfo_tail = callinfo->prev;
-
-  mrbc_free(vm, callinfo);
 }
 
 
@@ -289,15 +460,22 @@ void mrbc_pop_callinfo( struct VM *vm )
   @param vm_arg	Pointer to mrbc_vm or NULL.
   @return	Pointer to mrbc_vm.
   @retval NULL	error.
+  @note	The stacks of vm_arg are set by mrbc_vm_set_stack() after this.
+	If NULL, the VM is allocated with its mrbc_vm_stack.
 */
 mrbc_vm *mrbc_vm_open( struct VM *vm_arg )
 {
+  struct VM_WITH_STACK {
+    mrbc_vm vm;
+    mrbc_vm_stack stack;
+  } *vm_alloc = NULL;
   mrbc_vm *vm = vm_arg;
 
   if( vm == NULL ) {
     // allocate memory.
-    vm = mrbc_raw_alloc( sizeof(mrbc_vm) );
-    if( vm == NULL ) return NULL;
+    vm_alloc = mrbc_raw_alloc( sizeof(struct VM_WITH_STACK) );
+    if( vm_alloc == NULL ) return NULL;
+    vm = &vm_alloc->vm;
   }
 
   // allocate vm id.
@@ -324,12 +502,35 @@ mrbc_vm *mrbc_vm_open( struct VM *vm_arg )
 #endif
   if( vm_arg == NULL ) vm->flag_need_memfree = 1;
   vm->vm_id = vm_id;
-  vm->regs_size = MAX_REGS_SIZE;
+  if( vm_alloc ) {
+    mrbc_vm_set_stack( vm, vm_alloc->stack.regs, MAX_REGS_SIZE,
+		       vm_alloc->stack.callinfo, MAX_CALLINFO_COUNT );
+  }
 
   return vm;
 }
 
 
+//================================================================
+/*! Set the register and CALLINFO stacks of the VM.
+
+  @param  vm		Pointer to VM.
+  @param  regs		Register stack.
+  @param  regs_size	Size of regs.
+  @param  callinfo	CALLINFO stack.
+  @param  callinfo_size	Size of callinfo.
+*/
+void mrbc_vm_set_stack( struct VM *vm, mrbc_value *regs, int regs_size,
+			mrbc_callinfo *callinfo, int callinfo_size )
+{
+  vm->regs = regs;
+  vm->regs_size = regs_size;
+  vm->top_regs = regs;
+  vm->callinfo = callinfo;
+  vm->callinfo_size = callinfo_size;
+}
+
+
 //================================================================
 /*! Close the VM.
 
@@ -647,16 +848,17 @@ static inline void op_getiv( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_BB();
 
-  const char *sym_name = mrbc_irep_symbol_cstr(vm->cur_irep, b);
-  mrbc_sym sym_id = mrbc_str_to_symid(sym_name+1);   // skip '@'
-  if( sym_id < 0 ) {
-    mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
-    return;
-  }
-  mrbc_value *self = mrbc_get_self( vm, regs );
+  mrbc_sym sym_id = mrbc_irep_ivsymbol_id(vm->cur_irep, b);
+  mrbc_instance *self = mrbc_get_self( vm, regs )->instance;
+  int idx = find_ivar_by_access_site( vm, self->shape, sym_id );
 
   mrbc_decref(&regs[a]);
-  regs[a] = mrbc_instance_getiv(self, sym_id);
+  if( idx < 0 ) {
+    mrbc_set_nil(&regs[a]);
+  } else {
+    regs[a] = self->ivar[idx];
+    mrbc_incref(&regs[a]);
+  }
 }
 
 
@@ -669,15 +871,19 @@ static inline void op_setiv( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_BB();
 
-  const char *sym_name = mrbc_irep_symbol_cstr(vm->cur_irep, b);
-  mrbc_sym sym_id = mrbc_str_to_symid(sym_name+1);   // skip '@'
-  if( sym_id < 0 ) {
-    mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
+  mrbc_sym sym_id = mrbc_irep_ivsymbol_id(vm->cur_irep, b);
+  mrbc_value *self = mrbc_get_self( vm, regs );
+  int idx = find_ivar_by_access_site( vm, self->instance->shape, sym_id );
+
+  if( idx < 0 ) {
+    mrbc_instance_setiv(self, sym_id, &regs[a]);	// add new ivar.
     return;
   }
-  mrbc_value *self = mrbc_get_self( vm, regs );
 
-  mrbc_instance_setiv(self, sym_id, &regs[a]);
+  mrbc_value *iv = &self->instance->ivar[idx];
+  mrbc_incref(&regs[a]);
+  mrbc_decref(iv);
+  *iv = regs[a];
 }
 
 
@@ -835,7 +1041,7 @@ static inline void op_getupvar( mrbc_vm *vm, mrbc_value *regs EXT )
 
   mrbc_value *p_val;
   if( callinfo == 0 ) {
-    p_val = vm->regs + b;
+    p_val = vm->top_regs + b;
   } else {
     p_val = callinfo->cur_regs + callinfo->reg_offset + b;
   }
@@ -868,7 +1074,7 @@ static inline void op_setupvar( mrbc_vm *vm, mrbc_value *regs EXT )
 
   mrbc_value *p_val;
   if( callinfo == 0 ) {
-    p_val = vm->regs + b;
+    p_val = vm->top_regs + b;
   } else {
     p_val = callinfo->cur_regs + callinfo->reg_offset + b;
   }
@@ -1311,6 +1517,7 @@ static inline void op_super( mrbc_vm *vm, mrbc_value *regs EXT )
   }
 
   callinfo = mrbc_push_callinfo(vm, callinfo->method_id, a, b);
+  if( !callinfo ) return;
   callinfo->own_class = method.cls;
   callinfo->is_called_super = 1;
 
@@ -2242,7 +2449,8 @@ static inline void op_intern( mrbc_vm *vm, mrbc_value *regs EXT )
 
   assert( regs[a].tt == MRBC_TT_STRING );
 
-  mrbc_value sym_val = mrbc_symbol_new(vm, (const char*)regs[a].string->data);
+  mrbc_value sym_val = mrbc_symbol_new_n(vm, mrbc_string_ptr(&regs[a]),
+					 mrbc_string_size(&regs[a]));
 
   mrbc_decref( &regs[a] );
   regs[a] = sym_val;
@@ -2438,7 +2646,7 @@ static inline void op_exec( mrbc_vm *vm, mrbc_value *regs EXT )
   assert( regs[a].tt == MRBC_TT_CLASS );
 
   // prepare callinfo
-  mrbc_push_callinfo(vm, 0, a, 0);
+  if( !mrbc_push_callinfo(vm, 0, a, 0) ) return;
 
   // target irep
   vm->cur_irep = mrbc_irep_child_irep(vm->cur_irep, b);
@@ -2479,6 +2687,7 @@ static inline void op_def( mrbc_vm *vm, mrbc_value *regs EXT )
   method->irep = proc->irep;
   method->next = cls->method_link;
   cls->method_link = method;
+  mrbc_method_epoch_bump();
 
   // checking same method
   for( ;method->next != NULL; method = method->next ) {
@@ -2521,6 +2730,7 @@ static inline void op_alias( mrbc_vm *vm, mrbc_value *regs EXT )
   method->sym_id = sym_id_new;
   method->next = cls->method_link;
   cls->method_link = method;
+  mrbc_method_epoch_bump();
 
   // checking same method
   //  see OP_DEF function. same it.
@@ -2603,6 +2813,279 @@ static inline void op_unsupported( mrbc_vm *vm, mrbc_value *regs EXT )
 }
 #undef EXT
 
+//================================================================
+/*! Handle the raised exception.
+
+  Unwind the call stack until a catch handler (rescue or ensure) is
+  found, and jump to it.
+
+  @param  vm	A pointer to VM.
+  @retval 0	jumped to the handler.
+  @retval 2	no handler found.
+*/
+static inline int handle_exception( struct VM *vm )
+{
+  const mrbc_irep_catch_handler *handler;
+
+  vm->flag_preemption = 0;
+
+  while( 1 ) {
+    const mrbc_irep *irep = vm->cur_irep;
+    const mrbc_irep_catch_handler *catch_table =
+      (const mrbc_irep_catch_handler *)(irep->inst + irep->ilen);
+    uint32_t inst = vm->inst - irep->inst;
+    int cnt = irep->clen;
+
+    for( cnt--; cnt >= 0 ; cnt-- ) {
+      handler = catch_table + cnt;
+      if( (bin_to_uint32(handler->begin) < inst) &&
+	  (inst <= bin_to_uint32(handler->end)) ) goto JUMP_TO_HANDLER;
+    }
+
+    if( !vm->callinfo_tail ) return 2;	// return due to exception.
+    mrbc_pop_callinfo( vm );
+  }
+
+ JUMP_TO_HANDLER:
+  // jump to handler (rescue or ensure).
+  vm->inst = vm->cur_irep->inst + bin_to_uint32(handler->target);
+  return 0;
+}
+
+
+#if MRBC_USE_COMPUTED_GOTO
+//================================================================
+/*! Fetch a bytecode and execute (direct threaded version)
+
+  Opcodes that never raise, call, jump, yield or allocate go straight to
+  the next opcode. Others go through the preemption and exception check,
+  since an allocation that fails (ENOMEM) may leave an exception pending.
+
+  @param  vm	A pointer to VM.
+  @retval 0	(maybe) premption by timer.
+  @retval 1	program done.
+  @retval 2	exception occurred.
+*/
+int mrbc_vm_run( struct VM *vm )
+{
+#if defined(MRBC_SUPPORT_OP_EXT)
+  int ext = 0;
+#define EXT , ext
+#define NEXT()  ext = 0; goto *dispatch_table[*vm->inst++]
+#else
+#define EXT
+#define NEXT()  goto *dispatch_table[*vm->inst++]
+#endif
+#define CHECK() goto CHECK_PREEMPTION
+
+  // every entry is L_UNSUPPORTED first, then overridden by the opcodes.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverride-init"
+  static const void * const dispatch_table[256] = {
+    [0 ... 255]     = &&L_UNSUPPORTED,
+    [OP_NOP]        = &&L_NOP,
+    [OP_MOVE]       = &&L_MOVE,
+    [OP_LOADL]      = &&L_LOADL,
+    [OP_LOADI]      = &&L_LOADI,
+    [OP_LOADINEG]   = &&L_LOADINEG,
+    [OP_LOADI__1]   = &&L_LOADI_N,
+    [OP_LOADI_0]    = &&L_LOADI_N,
+    [OP_LOADI_1]    = &&L_LOADI_N,
+    [OP_LOADI_2]    = &&L_LOADI_N,
+    [OP_LOADI_3]    = &&L_LOADI_N,
+    [OP_LOADI_4]    = &&L_LOADI_N,
+    [OP_LOADI_5]    = &&L_LOADI_N,
+    [OP_LOADI_6]    = &&L_LOADI_N,
+    [OP_LOADI_7]    = &&L_LOADI_N,
+    [OP_LOADI16]    = &&L_LOADI16,
+    [OP_LOADI32]    = &&L_LOADI32,
+    [OP_LOADSYM]    = &&L_LOADSYM,
+    [OP_LOADNIL]    = &&L_LOADNIL,
+    [OP_LOADSELF]   = &&L_LOADSELF,
+    [OP_LOADT]      = &&L_LOADT,
+    [OP_LOADF]      = &&L_LOADF,
+    [OP_GETGV]      = &&L_GETGV,
+    [OP_SETGV]      = &&L_SETGV,
+    [OP_GETIV]      = &&L_GETIV,
+    [OP_SETIV]      = &&L_SETIV,
+    [OP_GETCONST]   = &&L_GETCONST,
+    [OP_SETCONST]   = &&L_SETCONST,
+    [OP_GETMCNST]   = &&L_GETMCNST,
+    [OP_GETUPVAR]   = &&L_GETUPVAR,
+    [OP_SETUPVAR]   = &&L_SETUPVAR,
+    [OP_GETIDX]     = &&L_GETIDX,
+    [OP_SETIDX]     = &&L_SETIDX,
+    [OP_JMP]        = &&L_JMP,
+    [OP_JMPIF]      = &&L_JMPIF,
+    [OP_JMPNOT]     = &&L_JMPNOT,
+    [OP_JMPNIL]     = &&L_JMPNIL,
+    [OP_JMPUW]      = &&L_JMPUW,
+    [OP_EXCEPT]     = &&L_EXCEPT,
+    [OP_RESCUE]     = &&L_RESCUE,
+    [OP_RAISEIF]    = &&L_RAISEIF,
+    [OP_SSEND]      = &&L_SSEND,
+    [OP_SSENDB]     = &&L_SSENDB,
+    [OP_SEND]       = &&L_SEND,
+    [OP_SENDB]      = &&L_SENDB,
+    [OP_SUPER]      = &&L_SUPER,
+    [OP_ARGARY]     = &&L_ARGARY,
+    [OP_ENTER]      = &&L_ENTER,
+    [OP_RETURN]     = &&L_RETURN,
+    [OP_RETURN_BLK] = &&L_RETURN_BLK,
+    [OP_BREAK]      = &&L_BREAK,
+    [OP_BLKPUSH]    = &&L_BLKPUSH,
+    [OP_ADD]        = &&L_ADD,
+    [OP_ADDI]       = &&L_ADDI,
+    [OP_SUB]        = &&L_SUB,
+    [OP_SUBI]       = &&L_SUBI,
+    [OP_MUL]        = &&L_MUL,
+    [OP_DIV]        = &&L_DIV,
+    [OP_EQ]         = &&L_EQ,
+    [OP_LT]         = &&L_LT,
+    [OP_LE]         = &&L_LE,
+    [OP_GT]         = &&L_GT,
+    [OP_GE]         = &&L_GE,
+    [OP_ARRAY]      = &&L_ARRAY,
+    [OP_ARRAY2]     = &&L_ARRAY2,
+    [OP_ARYCAT]     = &&L_ARYCAT,
+    [OP_ARYPUSH]    = &&L_ARYPUSH,
+    [OP_ARYDUP]     = &&L_ARYDUP,
+    [OP_AREF]       = &&L_AREF,
+    [OP_ASET]       = &&L_ASET,
+    [OP_APOST]      = &&L_APOST,
+    [OP_INTERN]     = &&L_INTERN,
+    [OP_SYMBOL]     = &&L_SYMBOL,
+    [OP_STRING]     = &&L_STRING,
+    [OP_STRCAT]     = &&L_STRCAT,
+    [OP_HASH]       = &&L_HASH,
+    [OP_HASHADD]    = &&L_HASHADD,
+    [OP_BLOCK]      = &&L_METHOD,
+    [OP_METHOD]     = &&L_METHOD,
+    [OP_RANGE_INC]  = &&L_RANGE_INC,
+    [OP_RANGE_EXC]  = &&L_RANGE_EXC,
+    [OP_CLASS]      = &&L_CLASS,
+    [OP_EXEC]       = &&L_EXEC,
+    [OP_DEF]        = &&L_DEF,
+    [OP_ALIAS]      = &&L_ALIAS,
+    [OP_SCLASS]     = &&L_SCLASS,
+    [OP_TCLASS]     = &&L_TCLASS,
+    [OP_EXT1]       = &&L_EXT1,
+    [OP_EXT2]       = &&L_EXT2,
+    [OP_EXT3]       = &&L_EXT3,
+    [OP_STOP]       = &&L_STOP,
+  };
+#pragma GCC diagnostic pop
+
+  mrbc_value *regs = vm->cur_regs;
+  NEXT();
+
+  // never raise, call, yield nor allocate.
+  L_NOP:        op_nop        (vm, regs EXT); NEXT();
+  L_MOVE:       op_move       (vm, regs EXT); NEXT();
+  L_LOADI:      op_loadi      (vm, regs EXT); NEXT();
+  L_LOADINEG:   op_loadineg   (vm, regs EXT); NEXT();
+  L_LOADI_N:    op_loadi_n    (vm, regs EXT); NEXT();
+  L_LOADI16:    op_loadi16    (vm, regs EXT); NEXT();
+  L_LOADI32:    op_loadi32    (vm, regs EXT); NEXT();
+  L_LOADSYM:    op_loadsym    (vm, regs EXT); NEXT();
+  L_LOADNIL:    op_loadnil    (vm, regs EXT); NEXT();
+  L_LOADSELF:   op_loadself   (vm, regs EXT); NEXT();
+  L_LOADT:      op_loadt      (vm, regs EXT); NEXT();
+  L_LOADF:      op_loadf      (vm, regs EXT); NEXT();
+  L_GETGV:      op_getgv      (vm, regs EXT); NEXT();
+  L_GETUPVAR:   op_getupvar   (vm, regs EXT); NEXT();
+  L_SETUPVAR:   op_setupvar   (vm, regs EXT); NEXT();
+  L_EXCEPT:     op_except     (vm, regs EXT); NEXT();
+  L_RESCUE:     op_rescue     (vm, regs EXT); NEXT();
+  L_EQ:         op_eq         (vm, regs EXT); NEXT();
+  L_LT:         op_lt         (vm, regs EXT); NEXT();
+  L_LE:         op_le         (vm, regs EXT); NEXT();
+  L_GT:         op_gt         (vm, regs EXT); NEXT();
+  L_GE:         op_ge         (vm, regs EXT); NEXT();
+  L_AREF:       op_aref       (vm, regs EXT); NEXT();
+  L_SCLASS:     op_sclass     (vm, regs EXT); NEXT();
+  L_TCLASS:     op_tclass     (vm, regs EXT); NEXT();
+
+  // may raise, call, jump, yield or allocate.
+  L_LOADL:      op_loadl      (vm, regs EXT); CHECK();
+  L_GETIV:      op_getiv      (vm, regs EXT); CHECK();
+  L_SETIV:      op_setiv      (vm, regs EXT); CHECK();
+  L_GETCONST:   op_getconst   (vm, regs EXT); CHECK();
+  L_GETMCNST:   op_getmcnst   (vm, regs EXT); CHECK();
+  L_GETIDX:     op_getidx     (vm, regs EXT); CHECK();
+  L_SETIDX:     op_setidx     (vm, regs EXT); CHECK();
+  L_JMP:        op_jmp        (vm, regs EXT); CHECK();
+  L_JMPIF:      op_jmpif      (vm, regs EXT); CHECK();
+  L_JMPNOT:     op_jmpnot     (vm, regs EXT); CHECK();
+  L_JMPNIL:     op_jmpnil     (vm, regs EXT); CHECK();
+  L_JMPUW:      op_jmpuw      (vm, regs EXT); CHECK();
+  L_RAISEIF:    op_raiseif    (vm, regs EXT); CHECK();
+  L_SSEND:      op_ssend      (vm, regs EXT); CHECK();
+  L_SSENDB:     op_ssendb     (vm, regs EXT); CHECK();
+  L_SEND:       op_send       (vm, regs EXT); CHECK();
+  L_SENDB:      op_sendb      (vm, regs EXT); CHECK();
+  L_SUPER:      op_super      (vm, regs EXT); CHECK();
+  L_ARGARY:     op_argary     (vm, regs EXT); CHECK();
+  L_ENTER:      op_enter      (vm, regs EXT); CHECK();
+  L_RETURN:     op_return     (vm, regs EXT); CHECK();
+  L_RETURN_BLK: op_return_blk (vm, regs EXT); CHECK();
+  L_BREAK:      op_break      (vm, regs EXT); CHECK();
+  L_BLKPUSH:    op_blkpush    (vm, regs EXT); CHECK();
+  L_ADD:        op_add        (vm, regs EXT); CHECK();
+  L_ADDI:       op_addi       (vm, regs EXT); CHECK();
+  L_SUB:        op_sub        (vm, regs EXT); CHECK();
+  L_SUBI:       op_subi       (vm, regs EXT); CHECK();
+  L_MUL:        op_mul        (vm, regs EXT); CHECK();
+  L_DIV:        op_div        (vm, regs EXT); CHECK();
+  L_INTERN:     op_intern     (vm, regs EXT); CHECK();
+  L_SYMBOL:     op_symbol     (vm, regs EXT); CHECK();
+  L_STRING:     op_string     (vm, regs EXT); CHECK();
+  L_STRCAT:     op_strcat     (vm, regs EXT); CHECK();
+  L_SETGV:      op_setgv      (vm, regs EXT); CHECK();
+  L_SETCONST:   op_setconst   (vm, regs EXT); CHECK();
+  L_ARRAY:      op_array      (vm, regs EXT); CHECK();
+  L_ARRAY2:     op_array2     (vm, regs EXT); CHECK();
+  L_ARYCAT:     op_arycat     (vm, regs EXT); CHECK();
+  L_ARYPUSH:    op_arypush    (vm, regs EXT); CHECK();
+  L_ARYDUP:     op_arydup     (vm, regs EXT); CHECK();
+  L_ASET:       op_aset       (vm, regs EXT); CHECK();
+  L_APOST:      op_apost      (vm, regs EXT); CHECK();
+  L_HASH:       op_hash       (vm, regs EXT); CHECK();
+  L_HASHADD:    op_hashadd    (vm, regs EXT); CHECK();
+  L_METHOD:     op_method     (vm, regs EXT); CHECK();
+  L_RANGE_INC:  op_range_inc  (vm, regs EXT); CHECK();
+  L_RANGE_EXC:  op_range_exc  (vm, regs EXT); CHECK();
+  L_DEF:        op_def        (vm, regs EXT); CHECK();
+  L_CLASS:      op_class      (vm, regs EXT); CHECK();
+  L_EXEC:       op_exec       (vm, regs EXT); CHECK();
+  L_ALIAS:      op_alias      (vm, regs EXT); CHECK();
+  L_STOP:       op_stop       (vm, regs EXT); CHECK();
+#if defined(MRBC_SUPPORT_OP_EXT)
+  L_EXT1:       ext = 1; goto *dispatch_table[*vm->inst++];
+  L_EXT2:       ext = 2; goto *dispatch_table[*vm->inst++];
+  L_EXT3:       ext = 3; goto *dispatch_table[*vm->inst++];
+#else
+  L_EXT1:       // fall through
+  L_EXT2:       // fall through
+  L_EXT3:       op_ext        (vm, regs EXT); CHECK();
+#endif
+  L_UNSUPPORTED: op_unsupported(vm, regs EXT); CHECK();
+
+ CHECK_PREEMPTION:
+  if( vm->flag_preemption ) {
+    if( !mrbc_israised(vm) ) return vm->flag_stop; // normal return.
+    if( handle_exception(vm) != 0 ) return 2;
+  }
+  regs = vm->cur_regs;
+  NEXT();
+
+#undef EXT
+#undef NEXT
+#undef CHECK
+}
+
+
+#else
 //================================================================
 /*! Fetch a bytecode and execute
 
@@ -2747,30 +3230,8 @@ int mrbc_vm_run( struct VM *vm )
     if( !vm->flag_preemption ) continue;	// execute next ope code.
     if( !mrbc_israised(vm) ) return vm->flag_stop; // normal return.
 
-
     // Handle exception
-    vm->flag_preemption = 0;
-    const mrbc_irep_catch_handler *handler;
-
-    while( 1 ) {
-      const mrbc_irep *irep = vm->cur_irep;
-      const mrbc_irep_catch_handler *catch_table =
-	(const mrbc_irep_catch_handler *)(irep->inst + irep->ilen);
-      uint32_t inst = vm->inst - irep->inst;
-      int cnt = irep->clen;
-
-      for( cnt--; cnt >= 0 ; cnt-- ) {
-	handler = catch_table + cnt;
-	if( (bin_to_uint32(handler->begin) < inst) &&
-	    (inst <= bin_to_uint32(handler->end)) ) goto JUMP_TO_HANDLER;
-      }
-
-      if( !vm->callinfo_tail ) return 2;	// return due to exception.
-      mrbc_pop_callinfo( vm );
-    }
-
-  JUMP_TO_HANDLER:
-    // jump to handler (rescue or ensure).
-    vm->inst = vm->cur_irep->inst + bin_to_uint32(handler->target);
+    if( handle_exception(vm) != 0 ) return 2;
   }
 }
+#endif
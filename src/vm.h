@@ -57,6 +57,7 @@ typedef struct IREP {
 
   uint8_t data[];		//!< variable data. (see load.c)
 				//!<  mrbc_sym   tbl_syms[slen]
+				//!<  mrbc_sym   tbl_ivsyms[slen]
 				//!<  uint16_t   tbl_pools[plen]
 				//!<  mrbc_irep *tbl_ireps[rlen]
 } mrbc_irep;
@@ -72,10 +73,17 @@ typedef struct IREP mrb_irep;
 //! get a n'th symbol string in irep
 #define mrbc_irep_symbol_cstr(irep, n)	mrbc_symid_to_str( mrbc_irep_symbol_id(irep, n) )
 
+//! get a instance variable symbol id table pointer.
+#define mrbc_irep_tbl_ivsyms(irep) \
+  ( mrbc_irep_tbl_syms(irep) + (irep)->slen )
+
+//! get a n'th symbol id in irep, that removed '@' if instance variable.
+#define mrbc_irep_ivsymbol_id(irep, n)	mrbc_irep_tbl_ivsyms(irep)[(n)]
+
 
 //! get a pool data offset table pointer.
 #define mrbc_irep_tbl_pools(irep) \
-  ( (uint16_t *) ((irep)->data + (irep)->slen * sizeof(mrbc_sym)) )
+  ( (uint16_t *) ((irep)->data + (irep)->slen * sizeof(mrbc_sym) * 2) )
 
 //! get a pointer to n'th pool data.
 #define mrbc_irep_pool_ptr(irep, n) \
@@ -138,23 +146,41 @@ typedef struct VM {
   unsigned int flag_need_memfree : 1;
   unsigned int flag_stop : 1;
   unsigned int flag_permanence : 1;
+  unsigned int flag_fiber : 1;		//!< this is a Fiber. (see c_fiber.c)
 
   uint16_t	  regs_size;		//!< size of regs[]
+  uint8_t	  callinfo_size;	//!< size of callinfo[]
 
   mrbc_irep       *top_irep;		//!< IREP tree top.
   const mrbc_irep *cur_irep;		//!< IREP currently running.
   const uint8_t   *inst;		//!< Instruction pointer.
   mrbc_value	  *cur_regs;		//!< Current register top.
   mrbc_class      *target_class;	//!< Target class.
-  mrbc_callinfo	  *callinfo_tail;	//!< Last point of CALLINFO link.
+  mrbc_callinfo	  *callinfo_tail;	//!< Last point of CALLINFO stack.
   mrbc_proc	  *ret_blk;		//!< Return block.
 
   mrbc_value	  exception;		//!< Raised exception or nil.
-  mrbc_value      regs[MAX_REGS_SIZE];
+  mrbc_value	  *regs;		//!< Registers.
+  mrbc_value	  *top_regs;		//!< Registers of the top level.
+  mrbc_callinfo	  *callinfo;		//!< CALLINFO stack.
 } mrbc_vm;
 typedef struct VM mrb_vm;
 
 
+//================================================================
+/*!@brief
+  Register and CALLINFO stacks of the full size, for a VM.
+
+  mrbc_vm_open(NULL) allocates one along with the VM. The owner of a VM
+  given to mrbc_vm_open() sets its own by mrbc_vm_set_stack().
+  (a Fiber has smaller ones, see c_fiber.h)
+*/
+typedef struct VM_STACK {
+  mrbc_value	  regs[MAX_REGS_SIZE];
+  mrbc_callinfo	  callinfo[MAX_CALLINFO_COUNT];
+} mrbc_vm_stack;
+
+
 /***** Global variables *****************************************************/
 /***** Function prototypes **************************************************/
 void mrbc_cleanup_vm(void);
@@ -163,6 +189,7 @@ const char *mrbc_get_callee_name(struct VM *vm);
 mrbc_callinfo *mrbc_push_callinfo(struct VM *vm, mrbc_sym method_id, int reg_offset, int n_args);
 void mrbc_pop_callinfo(struct VM *vm);
 mrbc_vm *mrbc_vm_open(struct VM *vm_arg);
+void mrbc_vm_set_stack(struct VM *vm, mrbc_value *regs, int regs_size, mrbc_callinfo *callinfo, int callinfo_size);
 void mrbc_vm_close(struct VM *vm);
 void mrbc_vm_begin(struct VM *vm);
 void mrbc_vm_end(struct VM *vm);
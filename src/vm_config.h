@@ -25,12 +25,54 @@
 #define MAX_REGS_SIZE 110
 #endif
 
+// maximum depth of method and block calls (size of CALLINFO stack)
+#if !defined(MAX_CALLINFO_COUNT)
+#define MAX_CALLINFO_COUNT 32
+#endif
+
+// size of registers and CALLINFO stack of a Fiber.
+#if !defined(MAX_FIBER_REGS_SIZE)
+#define MAX_FIBER_REGS_SIZE 32
+#endif
+#if !defined(MAX_FIBER_CALLINFO_COUNT)
+#define MAX_FIBER_CALLINFO_COUNT 8
+#endif
+
 // maximum number of symbols
 #if !defined(MAX_SYMBOLS_COUNT)
 #define MAX_SYMBOLS_COUNT 255
 #endif
 
 
+// size of per call site (inline) method cache used by OP_SEND etc.
+//  must be a power of 2. 0 to disable.
+#if !defined(MRBC_INLINE_METHOD_CACHE_SIZE)
+#define MRBC_INLINE_METHOD_CACHE_SIZE 64
+#endif
+
+// size of global method cache keyed by (class, method symbol).
+//  must be a power of 2. 0 to disable.
+#if !defined(MRBC_GLOBAL_METHOD_CACHE_SIZE)
+#define MRBC_GLOBAL_METHOD_CACHE_SIZE 64
+#endif
+
+// size of per call site (inline) instance variable slot cache used by
+//  OP_GETIV and OP_SETIV. must be a power of 2. 0 to disable.
+#if !defined(MRBC_INLINE_IVAR_CACHE_SIZE)
+#define MRBC_INLINE_IVAR_CACHE_SIZE 32
+#endif
+
+// opcode dispatch method in mrbc_vm_run().
+//  0: switch statement, 1: computed goto (GCC labels as values).
+#if !defined(MRBC_USE_COMPUTED_GOTO)
+# if defined(__GNUC__)
+#  define MRBC_USE_COMPUTED_GOTO 1
+# else
+#  define MRBC_USE_COMPUTED_GOTO 0
+# endif
+#endif
+
+
 // memory management
 //  MRBC_ALLOC_16BIT or MRBC_ALLOC_24BIT
 #define MRBC_ALLOC_16BIT
@@ -0,0 +1,316 @@
+#!/usr/bin/env ruby
+#
+# check the slides on the host build, against the golden images.
+#
+#  This file is distributed under BSD 3-Clause License.
+#
+# (usage)
+# ruby check_slides.rb [option] example.txt
+#
+#  -m megamrbc of the host build. (default: host/megamrbc)
+#  -g golden image directory. (default: host/golden)
+#  -o output directory. (default: host/out/frames)
+#  -u update the golden images
+#  -v verbose
+#
+# Walks through every page of the slides on megamrbc, pressing the buttons
+# for the pauses and the special pages, and compares the last frame of each
+# page with its golden image (pageN.png). For a page that differs, the frame
+# and the differing pixels (in red) are written to the output directory.
+# The VDP accesses of each page are reported, see README.md.
+#
+
+require "optparse"
+require "zlib"
+
+# frames to wait after a press, for the page to be drawn.
+WAIT_FRAMES = 60
+
+# the commands of the slides that wait for the joypad. see compile_slides.rb
+INPUT_COMMAND = {
+  "-pz:"            => :pause,
+  "-scroll:"        => :scroll,
+  "-titlescreen:"   => :title_screen,
+  "-demogame:"      => :demo_game,
+}
+
+
+##
+# verbose print
+#
+def vp( s, level = 1 )
+  STDERR.puts s  if $options[:v] >= level
+end
+
+
+##
+# parse command line option
+#
+def get_options
+  host_dir = File.join( __dir__, "..", "host" )
+  opt = OptionParser.new
+  ret = {:v=>0}
+
+  opt.on("-m megamrbc") {|v| ret[:m] = v }
+  opt.on("-g golden image directory") {|v| ret[:g] = v }
+  opt.on("-o output directory") {|v| ret[:o] = v }
+  opt.on("-u", "update the golden images") {|v| ret[:u] = true }
+  opt.on("-v", "verbose mode") {|v| ret[:v] += 1 }
+  opt.parse!(ARGV)
+
+  if ARGV.size != 1
+    STDERR.puts opt.help
+    return nil
+  end
+  ret[:i] = ARGV[0]
+  ret[:m] ||= File.join( host_dir, "megamrbc" )
+  ret[:g] ||= File.join( host_dir, "golden" )
+  ret[:o] ||= File.join( host_dir, "out", "frames" )
+
+  return ret
+
+rescue OptionParser::MissingArgument =>ex
+  STDERR.puts ex.message
+  return nil
+end
+
+
+##
+# split the content into pages. same rule as compile_slides.rb
+#
+def split_pages( content )
+  pages = []
+  start = 0
+  idx = 1
+  while idx < content.size
+    if content[idx] == "=" && content[idx-1] == "\n" && content[idx+1] == "\n"
+      pages << content[start...idx]
+      start = idx + 1
+    end
+    idx += 1
+  end
+  pages << content[start..-1]
+
+  return pages
+end
+
+
+##
+# joypad script of megamrbc, a section a page. (see host/sys.c)
+#
+# A section begins with the press that brings the page, and ends when the
+# next page is brought, so that its last frame is the complete page.
+#
+def joypad_script( pages )
+  script = []
+  press = nil                   # page 0 is drawn at boot
+
+  pages.each_with_index {|page, i|
+    script << "@page#{i} #{press} #{WAIT_FRAMES}".squeeze(" ")
+    press = "A"
+
+    page.each_line {|line|
+      case INPUT_COMMAND[line.strip]
+      when :pause, :scroll
+        script << "  A #{WAIT_FRAMES / 2}"
+      when :title_screen        # "Press start" three times.
+        script << "  START #{WAIT_FRAMES} START #{WAIT_FRAMES}"
+        press = "START"
+        break
+      when :demo_game           # jump twice, START ends the game.
+        script << "  A #{WAIT_FRAMES / 2} A #{WAIT_FRAMES / 2}"
+        press = "START"
+        break
+      end
+    }
+  }
+
+  script.join("\n") + "\n"
+end
+
+
+##
+# RGB image, 3 bytes a pixel.
+#
+class Frame
+  attr_reader :width, :height, :rgb
+
+  def initialize( width, height, rgb )
+    @width = width
+    @height = height
+    @rgb = rgb
+  end
+
+  def self.load_ppm( filename )
+    data = File.binread( filename )
+    magic, width, height, max, rgb = data.split(/\s+/, 5)
+    raise "#{filename}: not a binary PPM."  if magic != "P6" || max != "255"
+    self.new( width.to_i, height.to_i, rgb )
+  end
+
+  # only 8 bit RGB, as save_png writes.
+  def self.load_png( filename )
+    data = File.binread( filename )
+    pos = 8
+    idat = "".b
+    width = height = nil
+    while pos < data.bytesize
+      len, type = data[pos, 8].unpack("Na4")
+      chunk = data[pos + 8, len]
+      case type
+      when "IHDR"
+        width, height, depth, ctype, _, _, interlace = chunk.unpack("NNCCCCC")
+        if depth != 8 || ctype != 2 || interlace != 0
+          raise "#{filename}: not an 8 bit RGB, non-interlaced PNG."
+        end
+      when "IDAT"
+        idat << chunk
+      end
+      pos += len + 12
+    end
+
+    raw = Zlib::Inflate.inflate( idat )
+    stride = width * 3
+    prev = [0] * stride
+    rgb = "".b
+    height.times {|y|
+      filter = raw.getbyte(y * (stride + 1))
+      line = raw[y * (stride + 1) + 1, stride].bytes
+      line.each_index {|i|
+        a = (i >= 3) ? line[i - 3] : 0
+        b = prev[i]
+        c = (i >= 3) ? prev[i - 3] : 0
+        line[i] = (line[i] + case filter
+                             when 0 then 0
+                             when 1 then a
+                             when 2 then b
+                             when 3 then (a + b) / 2
+                             when 4 then paeth(a, b, c)
+                             end) & 0xff
+      }
+      rgb << line.pack("C*")
+      prev = line
+    }
+    self.new( width, height, rgb )
+  end
+
+  def self.paeth( a, b, c )
+    p = a + b - c
+    pa = (p - a).abs
+    pb = (p - b).abs
+    pc = (p - c).abs
+    return a  if pa <= pb && pa <= pc
+    return b  if pb <= pc
+    return c
+  end
+
+  def save_png( filename )
+    stride = @width * 3
+    raw = (0...@height).map {|y| "\0".b + @rgb[y * stride, stride] }.join
+    File.binwrite( filename, "\x89PNG\r\n\x1a\n".b +
+                   png_chunk( "IHDR", [@width, @height, 8, 2, 0, 0, 0].pack("NNCCCCC") ) +
+                   png_chunk( "IDAT", Zlib::Deflate.deflate( raw, Zlib::BEST_COMPRESSION ) ) +
+                   png_chunk( "IEND", "".b ) )
+  end
+
+  def png_chunk( type, data )
+    [data.bytesize].pack("N") + type.b + data + [Zlib.crc32( type + data )].pack("N")
+  end
+
+  # the pixels that differ from other, in red over the dimmed image.
+  def diff( other )
+    count = 0
+    rgb = "".b
+    (0...@width * @height).each {|i|
+      px = @rgb[i * 3, 3]
+      if px != other.rgb[i * 3, 3]
+        count += 1
+        rgb << "\xff\0\0".b
+      else
+        grey = px.bytes.sum / 9
+        rgb << [grey, grey, grey].pack("C*")
+      end
+    }
+    return count, Frame.new( @width, @height, rgb )
+  end
+end
+
+
+##
+# runs megamrbc, and returns the report: label => {column => value}
+#
+def run_megamrbc( script )
+  vp( script, 2 )
+  output = IO.popen( [$options[:m], "-j", "-", "-d", $options[:o]], "r+" ) {|io|
+    io.write( script )
+    io.close_write
+    io.read
+  }
+  if !$?.success?
+    STDERR.puts output
+    STDERR.puts "#{$options[:m]} failed. (exit status #{$?.exitstatus})"
+    exit 1
+  end
+
+  header, *rows = output.lines.map {|line| line.sub(/\A# /, "#").split }
+  rows.to_h {|label, *values| [label, header[1..].zip( values.map(&:to_i) ).to_h] }
+end
+
+
+##
+# main
+#
+$options = get_options()
+exit 1 if !$options
+
+pages = split_pages( File.read( $options[:i] ) )
+vp("#{$options[:i]}: #{pages.size} pages.")
+
+Dir.mkdir( $options[:o] )  if !Dir.exist?( $options[:o] )
+Dir.mkdir( $options[:g] )  if $options[:u] && !Dir.exist?( $options[:g] )
+report = run_megamrbc( joypad_script( pages ) )
+
+failed = 0
+puts "%-8s %6s %6s %8s %8s %7s %8s" % %w[#page frames calls cpu_w dma_b dma_pk diff_px]
+pages.each_index {|i|
+  label = "page#{i}"
+  stats = report[label]
+  if !stats
+    puts "%-8s (not reached)" % label
+    failed += 1
+    next
+  end
+
+  frame = Frame.load_ppm( File.join( $options[:o], "#{label}.ppm" ) )
+  golden_file = File.join( $options[:g], "#{label}.png" )
+  if $options[:u]
+    frame.save_png( golden_file )
+    result = "updated"
+  elsif !File.exist?( golden_file )
+    result = "no golden"
+    failed += 1
+  else
+    count, diff = frame.diff( Frame.load_png( golden_file ) )
+    result = count
+    if count > 0
+      frame.save_png( File.join( $options[:o], "#{label}.png" ) )
+      diff.save_png( File.join( $options[:o], "#{label}-diff.png" ) )
+      failed += 1
+    end
+  end
+
+  puts "%-8s %6d %6d %8d %8d %7d %8s" %
+       [label, *stats.values_at("frames", "calls", "cpu_w", "dma_b", "dma_pk"), result]
+}
+
+# the most expensive slides.
+costly = pages.each_index.map {|i| "page#{i}" }.select {|label| report[label] }
+["dma_b", "cpu_w"].each {|column|
+  label = costly.max_by {|l| report[l][column] }
+  puts "# most #{column}: #{label} (#{report[label][column]})"  if label
+}
+
+if failed > 0
+  puts "#{failed} page(s) differ. see #{$options[:o]}"
+  exit 1
+end
@@ -0,0 +1,340 @@
+#!/usr/bin/env ruby
+#
+# compile slide markup into a binary display list.
+#
+#  This file is distributed under BSD 3-Clause License.
+#
+# (usage)
+# ruby compile_slides.rb [option] input.txt
+#
+#  -o output filename. (default: input filename with .slides extension)
+#  -v verbose
+#
+# The markup is the one documented in res/bin/example.txt. Every line is
+# parsed here on the host, and the device only walks the opcode stream.
+# See src/display_list.h for the binary format, the opcode numbers below
+# must match the ones defined there.
+#
+
+require "optparse"
+
+MAGIC = "MSL1"
+
+OP = {
+  :end        => 0x00,
+  :text       => 0x01,
+  :text_bg    => 0x02,
+  :txtpal     => 0x03,
+  :setcolour  => 0x04,
+  :bgcol      => 0x05,
+  :img        => 0x06,
+  :rect       => 0x07,
+  :arrow      => 0x08,
+  :sleep      => 0x09,
+  :playsound  => 0x0a,
+  :renderbg   => 0x0b,
+  :event      => 0x0c,
+}
+
+EVENT = {
+  :pause         => 0,
+  :show_timer    => 1,
+  :hide_timer    => 2,
+  :title_screen  => 3,
+  :demo_game     => 4,
+  :scroll        => 5,
+  :init_progress => 6,
+  :reset_timer   => 7,
+}
+
+# simple commands that hand over control to Ruby (Presentation).
+EVENT_COMMAND = {
+  "-pz:"            => :pause,
+  "-setshowtimer:"  => :show_timer,
+  "-sethidetimer:"  => :hide_timer,
+  "-titlescreen:"   => :title_screen,
+  "-demogame:"      => :demo_game,
+  "-scroll:"        => :scroll,
+  "-initprogress:"  => :init_progress,
+  "-resettimer:"    => :reset_timer,
+}
+
+CODE_KEYWORDS = ["do", "end", "if", "unless", "else", "elsif", "while",
+                 "for", "class", "def"]
+
+SCREEN_WIDTH = 40
+
+
+##
+# verbose print
+#
+def vp( s, level = 1 )
+  STDERR.puts s  if $options[:v] >= level
+end
+
+
+##
+# parse command line option
+#
+def get_options
+  opt = OptionParser.new
+  ret = {:v=>0}
+
+  opt.on("-o output file") {|v| ret[:o] = v }
+  opt.on("-v") {|v| ret[:v] += 1 }
+  opt.parse!(ARGV)
+
+  if ARGV.size != 1
+    STDERR.puts opt.help
+    exit 1
+  end
+  ret[:i] = ARGV[0]
+  ret[:o] ||= ret[:i].sub(/\.[^.\/]*\z/, "") + ".slides"
+
+  return ret
+end
+
+
+##
+# split the content into pages. same rule as MegaMrbc.read_page_at
+#
+def split_pages( content )
+  pages = []
+  start = 0
+  idx = 1
+  while idx < content.size
+    if content[idx] == "=" && content[idx-1] == "\n" && content[idx+1] == "\n"
+      pages << content[start...idx]
+      start = idx + 1
+    end
+    idx += 1
+  end
+  pages << content[start..-1]
+
+  return pages
+end
+
+
+##
+# Emits the opcode stream of one page.
+#
+class PageCompiler
+  attr_reader :bytes
+
+  def initialize( first_lineno )
+    @bytes = "".b
+    @first_lineno = first_lineno
+    @lineno = first_lineno
+    @txtpal = nil       # unknown
+  end
+
+  def u8( n )
+    raise "line #{@lineno}: #{n} is out of range (0..255)"  if n < 0 || n > 255
+    @bytes << [n].pack("C")
+  end
+
+  def u16( n )
+    raise "line #{@lineno}: #{n} is out of range (0..65535)"  if n < 0 || n > 65535
+    @bytes << [n].pack("n")
+  end
+
+  def str( s )
+    s = s.b[0, SCREEN_WIDTH]
+    u8( s.bytesize )
+    @bytes << s
+  end
+
+  def op( name )
+    u8( OP[name] )
+  end
+
+  def event( name )
+    op( :event ); u8( EVENT[name] )
+    @txtpal = nil       # Ruby side may change the text palette.
+  end
+
+  def text( s, x, y )
+    op( :text ); u8( x ); u8( y ); str( s )
+  end
+
+  def txtpal( pal )
+    return  if @txtpal == pal
+    op( :txtpal ); u8( pal )
+    @txtpal = pal
+  end
+
+  ##
+  # compile a line of code mode. same colouring as draw_code_n() in main.c
+  #
+  def code_line( txt, x, y )
+    runs = []           # [[palette, text], ...]
+    txt.split('"').each_with_index {|f, i|
+      if i % 2 == 0
+        break_line( f ).each {|t| runs << [term_palette(t), t] }
+      else
+        runs << [2, '"' + f + '"']
+      end
+    }
+
+    offset = 0
+    runs.chunk_while {|a, b| a[0] == b[0] }.each {|run|
+      s = run.map {|r| r[1] }.join
+      txtpal( run[0][0] )
+      text( s, x + offset, y )
+      offset += s.size
+    }
+  end
+
+  ##
+  # split the line into words and runs of spaces.
+  #
+  def break_line( line )
+    line.scan(/ +|[^ ]+/)
+  end
+
+  def term_palette( term )
+    return 1  if ("A".."Z").include?(term[0])
+    return 3  if CODE_KEYWORDS.include?(term)
+    return 0
+  end
+
+  def params( line )
+    line.split(":")[0].split(",")
+  end
+
+  def after_colon( line )
+    idx = line.index(":")
+    raise "line #{@lineno}: ':' is missing."  if !idx
+    line[(idx + 1)..-1]
+  end
+
+  def arrow( line, tee )
+    cmd = params( line )
+    dir = cmd[3].to_s
+    if !["r", "l", "u", "d"].include?(dir)
+      STDERR.puts "line #{@lineno}: unknown arrow direction '#{dir}', ignored."
+      return
+    end
+    op( :arrow ); u8( cmd[1].to_i ); u8( cmd[2].to_i )
+    u8( dir.ord ); u8( cmd[4].to_i ); u8( tee ? 1 : 0 )
+  end
+
+  ##
+  # compile a page. same rules as the former Page#render
+  #
+  def compile( content )
+    curr_mode = nil
+    x = y = 0
+
+    content.split("\n").each_with_index {|line, i|
+      @lineno = @first_lineno + i
+      next  if line[0] == '#'
+
+      event_cmd = EVENT_COMMAND.find {|k, v| line.start_with?(k) }
+      if event_cmd
+        curr_mode = nil  if event_cmd[1] == :pause
+        event( event_cmd[1] )
+
+      elsif line.start_with?("-title:")
+        curr_mode = nil
+        text( line.split("-title:")[1].to_s, 2, 0 )
+
+      elsif line.start_with?("-txt,")
+        curr_mode = :text
+        cmd = params( line )
+        x = cmd[1].to_i
+        y = cmd[2].to_i
+        s = after_colon( line )
+        if cmd[3]
+          op( :text_bg ); u8( x ); u8( y ); u8( cmd[3][2].to_i ); str( s )
+        else
+          text( s, x, y )
+        end
+
+      elsif line.start_with?("-setcolour,")
+        curr_mode = nil
+        cmd = params( line )
+        op( :setcolour ); u8( cmd[1].to_i ); u16( cmd[2].to_i(16) )
+
+      elsif line.start_with?("-txtpal,")
+        curr_mode = nil
+        txtpal( params( line )[1].to_i )
+
+      elsif line.start_with?("-img,")
+        curr_mode = nil
+        cmd = params( line )
+        op( :img ); u8( cmd[1].to_i ); u8( cmd[2].to_i ); str( cmd[3] )
+
+      elsif line.start_with?("-code,")
+        curr_mode = :code
+        cmd = params( line )
+        x = cmd[1].to_i
+        y = cmd[2].to_i
+        code_line( after_colon( line ), x, y )
+
+      elsif line.start_with?("-rect,")
+        cmd = params( line )
+        op( :rect )
+        cmd[1..4].each {|n| u8( n.to_i ) }
+        u8( cmd[5] ? cmd[5].to_i : 0xff )
+
+      elsif line.start_with?("-arrow,")
+        arrow( line, false )
+
+      elsif line.start_with?("-tarrow,")
+        arrow( line, true )
+
+      elsif line.start_with?("-bgcol,")
+        op( :bgcol ); u16( params( line )[1].to_i(16) )
+
+      elsif line.start_with?("-sleep_raw,")
+        op( :sleep ); u16( params( line )[1].to_i )
+
+      elsif line.start_with?("-renderbg:")
+        op( :renderbg )
+
+      elsif line.start_with?("-playsound:")
+        op( :playsound )
+
+      elsif curr_mode == :text
+        y += 1
+        text( line, x, y )  if !line.empty?
+
+      elsif curr_mode == :code
+        y += 1
+        code_line( line, x, y )
+      end
+    }
+
+    op( :end )
+  end
+end
+
+
+##
+# main
+#
+$options = get_options()
+content = File.binread( $options[:i] )
+pages = split_pages( content )
+
+lineno = 1
+streams = pages.map {|page|
+  pc = PageCompiler.new( lineno )
+  pc.compile( page )
+  lineno += page.count("\n")
+  pc.bytes
+}
+
+header_size = MAGIC.size + 2 + 4 * (pages.size + 1)
+offsets = [header_size]
+streams.each {|s| offsets << offsets.last + s.bytesize }
+
+File.open( $options[:o], "wb" ) {|file|
+  file.write( MAGIC )
+  file.write( [pages.size].pack("n") )
+  file.write( offsets.pack("N*") )
+  streams.each {|s| file.write( s ) }
+}
+
+vp("#{$options[:o]}: #{pages.size} pages, #{offsets.last} bytes.")
@@ -0,0 +1,392 @@
+#!/usr/bin/env ruby
+#
+# create the resources of the host build from SGDK resource definition.
+#
+#  This file is distributed under BSD 3-Clause License.
+#
+# (usage)
+# ruby make_host_resources.rb [option] resources.res
+#
+#  -o output filename. (default: resources.c)
+#     the header is written next to it, with .h extension.
+#  -v verbose
+#
+# Does the part of rescomp that the host build (host/) needs: BIN, IMAGE,
+# SPRITE and WAV resources, from 1, 4 or 8 bit indexed PNG and BMP files.
+# Nothing is compressed. IMAGE tiles are optimised as rescomp does (ALL:
+# the duplicated and flipped tiles are removed). Only the first frame of
+# a SPRITE is kept, see host/inc/genesis.h
+#
+
+require "optparse"
+require "zlib"
+
+
+##
+# verbose print
+#
+def vp( s, level = 1 )
+  STDERR.puts s  if $options[:v] >= level
+end
+
+
+##
+# parse command line option
+#
+def get_options
+  opt = OptionParser.new
+  ret = {:v=>0}
+
+  opt.on("-o output file") {|v| ret[:o] = v }
+  opt.on("-v", "verbose mode") {|v| ret[:v] += 1 }
+  opt.parse!(ARGV)
+
+  if ARGV.size != 1
+    STDERR.puts opt.help
+    return nil
+  end
+  ret[:i] = ARGV[0]
+  ret[:o] ||= "resources.c"
+  ret[:h] = ret[:o].sub(/\.[^.\/]*\z/, "") + ".h"
+
+  return ret
+
+rescue OptionParser::MissingArgument =>ex
+  STDERR.puts ex.message
+  return nil
+end
+
+
+##
+# Indexed image.
+#
+class IndexedImage
+  attr_reader :width, :height, :pixels, :palette
+
+  def initialize( width, height, pixels, palette )
+    @width = width
+    @height = height
+    @pixels = pixels            # colour index, row by row.
+    @palette = palette          # [[r, g, b], ...]
+  end
+
+  def self.load( filename )
+    data = File.binread( filename )
+    if data.start_with?("\x89PNG".b)
+      load_png( filename, data )
+    elsif data.start_with?("BM")
+      load_bmp( filename, data )
+    else
+      raise "#{filename}: unknown image format."
+    end
+  end
+
+  def self.unpack_bits( bytes, depth, width )
+    return bytes.bytes[0, width]  if depth == 8
+    mask = (1 << depth) - 1
+    per_byte = 8 / depth
+    (0...width).map {|x|
+      (bytes.getbyte(x / per_byte) >> (8 - depth * (x % per_byte + 1))) & mask
+    }
+  end
+
+  def self.load_png( filename, data )
+    pos = 8
+    idat = "".b
+    palette = nil
+    width = height = depth = nil
+    while pos < data.bytesize
+      len, type = data[pos, 8].unpack("Na4")
+      chunk = data[pos + 8, len]
+      case type
+      when "IHDR"
+        width, height, depth, ctype, _, _, interlace = chunk.unpack("NNCCCCC")
+        if ctype != 3 || interlace != 0
+          raise "#{filename}: not an indexed, non-interlaced PNG."
+        end
+      when "PLTE"
+        palette = chunk.unpack("C*").each_slice(3).to_a
+      when "IDAT"
+        idat << chunk
+      end
+      pos += len + 12
+    end
+
+    raw = Zlib::Inflate.inflate( idat )
+    stride = (width * depth + 7) / 8
+    prev = "\0".b * stride
+    pixels = []
+    height.times {|y|
+      filter = raw.getbyte(y * (stride + 1))
+      line = raw[y * (stride + 1) + 1, stride].bytes
+      line.each_index {|i|
+        a = (i > 0) ? line[i - 1] : 0
+        b = prev.getbyte(i)
+        c = (i > 0) ? prev.getbyte(i - 1) : 0
+        line[i] = (line[i] + case filter
+                             when 0 then 0
+                             when 1 then a
+                             when 2 then b
+                             when 3 then (a + b) / 2
+                             when 4 then paeth(a, b, c)
+                             end) & 0xff
+      }
+      prev = line.pack("C*")
+      pixels.concat( unpack_bits( prev, depth, width ) )
+    }
+    self.new( width, height, pixels, palette )
+  end
+
+  def self.paeth( a, b, c )
+    p = a + b - c
+    pa = (p - a).abs
+    pb = (p - b).abs
+    pc = (p - c).abs
+    return a  if pa <= pb && pa <= pc
+    return b  if pb <= pc
+    return c
+  end
+
+  def self.load_bmp( filename, data )
+    offset = data[10, 4].unpack1("V")
+    hsize, width, height, planes, depth, comp, _, _, _, ncolours =
+      data[14, 36].unpack("VVl<vvVVVVV")
+    if ![1, 4, 8].include?(depth) || comp != 0
+      raise "#{filename}: not an uncompressed, indexed BMP."
+    end
+    ncolours = 1 << depth  if ncolours == 0
+    palette = data[14 + hsize, ncolours * 4].unpack("C*").each_slice(4).map {|b, g, r, _| [r, g, b] }
+
+    stride = ((width * depth + 31) / 32) * 4
+    rows = (0...height.abs).map {|y|
+      unpack_bits( data[offset + y * stride, stride], depth, width )
+    }
+    rows.reverse!  if height > 0          # bottom-up
+    self.new( width, height.abs, rows.flatten, palette )
+  end
+
+  def pixel( x, y )
+    @pixels[y * @width + x]
+  end
+
+  # 8x8 pixels of the tile.
+  def tile_pixels( tx, ty )
+    (0...8).flat_map {|y| (0...8).map {|x| pixel( tx * 8 + x, ty * 8 + y ) } }
+  end
+end
+
+
+##
+# a VDP colour of the palette. (0000 BBB0 GGG0 RRR0)
+#
+def vdp_colour( rgb )
+  r, g, b = rgb || [0, 0, 0]
+  ((b >> 5) << 9) | ((g >> 5) << 5) | ((r >> 5) << 1)
+end
+
+def vdp_palette( image, max_index )
+  size = [[(max_index / 16 + 1) * 16, 16].max, 64].min
+  (0...size).map {|i| vdp_colour( image.palette[i] ) }
+end
+
+##
+# a tile as 8 u32. the leftmost pixel is in the high nibble.
+#
+def tile_words( pixels )
+  pixels.each_slice(8).map {|row|
+    row.inject(0) {|w, px| (w << 4) | (px & 15) }
+  }
+end
+
+def hflip( pixels )
+  pixels.each_slice(8).flat_map(&:reverse)
+end
+
+def vflip( pixels )
+  pixels.each_slice(8).to_a.reverse.flatten
+end
+
+
+##
+# tiles and tilemap of an IMAGE.
+#
+def convert_image( image, optimise )
+  if image.width % 8 != 0 || image.height % 8 != 0
+    raise "image size must be a multiple of 8. (#{image.width}x#{image.height})"
+  end
+  tiles = []
+  index = {}                    # tile pixels => tilemap entry
+  tilemap = []
+
+  (0...image.height / 8).each {|ty|
+    (0...image.width / 8).each {|tx|
+      px = image.tile_pixels( tx, ty )
+      pal = (px.max >> 4) & 3
+      px = px.map {|c| c & 15 }
+
+      entry = index[px]
+      if !entry
+        entry = tiles.size
+        tiles << px
+        if optimise
+          index[px] = entry
+          index[hflip(px)] ||= entry | 0x0800
+          index[vflip(px)] ||= entry | 0x1000
+          index[vflip(hflip(px))] ||= entry | 0x1800
+        end
+      end
+      tilemap << ((pal << 13) | entry)
+    }
+  }
+
+  return tiles, tilemap
+end
+
+##
+# tiles of the first frame of a SPRITE, in the order of the VDP sprites:
+# blocks of up to 4x4 tiles, each block column by column.
+#
+def convert_sprite( image, w, h )
+  tiles = []
+  (0...h).step(4) {|by|
+    (0...w).step(4) {|bx|
+      (bx...[bx + 4, w].min).each {|tx|
+        (by...[by + 4, h].min).each {|ty|
+          tiles << image.tile_pixels( tx, ty ).map {|c| c & 15 }
+        }
+      }
+    }
+  }
+  tiles
+end
+
+
+##
+# wave data of a WAV file.
+#
+def wav_data( filename )
+  data = File.binread( filename )
+  pos = 12
+  while pos < data.bytesize
+    id, len = data[pos, 8].unpack("a4V")
+    return data[pos + 8, len]  if id == "data"
+    pos += 8 + len + (len & 1)
+  end
+  raise "#{filename}: no data chunk."
+end
+
+
+##
+# C source writer.
+#
+class Writer
+  attr_reader :source, :header
+
+  def initialize
+    @source = []
+    @header = []
+  end
+
+  def array( type, name, values, per_line, fmt, static = true )
+    @source << "#{static ? "static " : ""}const #{type} #{name}[#{values.size}] = {"
+    values.each_slice(per_line) {|vals|
+      @source << "  " + vals.map {|v| fmt % v }.join(", ") + ","
+    }
+    @source << "};"
+    @source << ""
+  end
+
+  def palette( name, colours )
+    array( "u16", "#{name}_palette_data", colours, 8, "0x%04X" )
+    @source << "static const Palette #{name}_palette = { #{colours.size}, (u16 *)#{name}_palette_data };"
+    @source << ""
+  end
+
+  def tileset( name, tiles )
+    array( "u32", "#{name}_tiles", tiles.flat_map {|t| tile_words( t ) }, 8, "0x%08X" )
+    @source << "static const TileSet #{name}_tileset = { COMPRESSION_NONE, #{tiles.size}, (u32 *)#{name}_tiles };"
+    @source << ""
+  end
+
+  def bytes( name, data )
+    array( "u8", name, data.bytes, 16, "%d", false )
+    @header << "extern const u8 #{name}[#{data.bytesize}];"
+  end
+
+  def image( name, image, optimise )
+    tiles, tilemap = convert_image( image, optimise )
+    palette( name, vdp_palette( image, image.pixels.max ) )
+    tileset( name, tiles )
+    array( "u16", "#{name}_tilemap_data", tilemap, 8, "0x%04X" )
+    @source << "static const TileMap #{name}_tilemap = { COMPRESSION_NONE, #{image.width / 8}, #{image.height / 8}, (u16 *)#{name}_tilemap_data };"
+    @source << "const Image #{name} = { (Palette *)&#{name}_palette, (TileSet *)&#{name}_tileset, (TileMap *)&#{name}_tilemap };"
+    @source << ""
+    @header << "extern const Image #{name};"
+    vp("#{name}: #{tiles.size} tiles.", 2)
+  end
+
+  def sprite( name, image, w, h )
+    palette( name, vdp_palette( image, 15 ) )
+    tileset( name, convert_sprite( image, w, h ) )
+    @source << "const SpriteDefinition #{name} = { #{w * 8}, #{h * 8}, (Palette *)&#{name}_palette, (TileSet *)&#{name}_tileset };"
+    @source << ""
+    @header << "extern const SpriteDefinition #{name};"
+  end
+end
+
+
+##
+# main
+#
+$options = get_options()
+exit 1 if !$options
+
+dir = File.dirname( $options[:i] )
+writer = Writer.new
+
+File.readlines( $options[:i] ).each_with_index {|line, i|
+  type, name, file, *params = line.split
+  next  if !type || type.start_with?("//")
+  file = File.join( dir, file.delete('"') )
+  vp("#{type} #{name} '#{file}'")
+
+  begin
+    case type
+    when "BIN"
+      # the content is read up to a 0.
+      writer.bytes( name, File.binread( file ) + "\0" )
+    when "WAV"
+      writer.bytes( name, wav_data( file ) )
+    when "IMAGE"
+      writer.image( name, IndexedImage.load( file ), (params[1] || "ALL") != "NONE" )
+    when "SPRITE"
+      writer.sprite( name, IndexedImage.load( file ), params[0].to_i, params[1].to_i )
+    else
+      raise "unsupported resource type '#{type}'."
+    end
+  rescue => ex
+    STDERR.puts "#{$options[:i]}:#{i + 1}: #{ex.message}"
+    exit 1
+  end
+}
+
+File.open( $options[:o], "w" ) {|file|
+  file.puts "/* Auto generated by make_host_resources.rb */"
+  file.puts "#include <genesis.h>"
+  file.puts
+  file.puts writer.source
+}
+
+File.open( $options[:h], "w" ) {|file|
+  file.puts "/* Auto generated by make_host_resources.rb */"
+  file.puts "#ifndef MEGAMRBC_HOST_RESOURCES_H_"
+  file.puts "#define MEGAMRBC_HOST_RESOURCES_H_"
+  file.puts
+  file.puts "#include <genesis.h>"
+  file.puts
+  file.puts writer.header
+  file.puts
+  file.puts "#endif"
+}
+
+vp("#{$options[:o]}: #{writer.header.size} resources.")
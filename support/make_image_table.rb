@@ -0,0 +1,142 @@
+#!/usr/bin/env ruby
+#
+# create image name table from SGDK resource definition.
+#
+#  This file is distributed under BSD 3-Clause License.
+#
+# (usage)
+# ruby make_image_table.rb [option] resources.res
+#
+#  -o output filename. (default: STDOUT)
+#  -v verbose
+#
+# Every IMAGE resource is registered by its name, and the short names
+# used in the slides are registered as aliases. The table is sorted in
+# the same order as strcmp(), so that main.c can use binary search.
+#
+
+require "optparse"
+
+# short name => resource name
+ALIAS = {}
+(0..8).each  {|i| ALIAS["d%03d" % i]     = "dev_proc_%03d" % i }
+(0..12).each {|i| ALIAS["m%03d" % i]     = "dev_w_mrubyc_%03d" % i }
+(0..4).each  {|i| ALIAS["ru%03d" % i]    = "resource_usage%03d" % i }
+(0..4).each  {|i| ALIAS["mrbld_%03d" % i] = "mrubyloading_%03d" % i }
+
+
+##
+# verbose print
+#
+def vp( s, level = 1 )
+  STDERR.puts s  if $options[:v] >= level
+end
+
+
+##
+# parse command line option
+#
+def get_options
+  opt = OptionParser.new
+  ret = {:v=>0}
+
+  opt.on("-o output file") {|v| ret[:o] = v }
+  opt.on("-v", "verbose mode") {|v| ret[:v] += 1 }
+  opt.parse!(ARGV)
+
+  if ARGV.size != 1
+    STDERR.puts opt.help
+    return nil
+  end
+  ret[:i] = ARGV[0]
+
+  return ret
+
+rescue OptionParser::MissingArgument =>ex
+  STDERR.puts ex.message
+  return nil
+end
+
+
+##
+# read resource definition file and extract IMAGE names.
+#
+def fetch_images( filename )
+  vp("Process '#{filename}'")
+
+  File.readlines( filename ).map {|line|
+    type, name = line.split
+    (type == "IMAGE") ? name : nil
+  }.compact
+end
+
+
+##
+# write image table file.
+#
+def write_file( entries )
+  vp("Output file '#{$options[:o] || "STDOUT"}'")
+  begin
+    file = $options[:o] ? File.open( $options[:o], "w" ) : $stdout
+  rescue Errno::ENOENT
+    puts "File can't open. #{$options[:o]}"
+    exit 1
+  end
+
+  file.puts "/* Auto generated by make_image_table.rb */"
+  file.puts "#ifndef MEGAMRBC_SRC_AUTOGEN_IMAGE_TABLE_H_"
+  file.puts "#define MEGAMRBC_SRC_AUTOGEN_IMAGE_TABLE_H_"
+  file.puts
+
+  file.puts "static const struct IMAGE_TABLE {"
+  file.puts "  const char *name;"
+  file.puts "  const Image *image;"
+  file.puts "} image_table[] = {"
+  entries.each_with_index {|(name, image), i|
+    s1 = %!  {"#{name}", &#{image}},!
+    s1 << "\t" * ([5 - s1.size / 8, 1].max)
+    s1 << "// IMAGE_ID_#{name} = #{i}"
+    file.puts s1
+  }
+  file.puts "};"
+  file.puts
+
+  file.puts "enum {"
+  entries.each_with_index {|(name, image), i|
+    file.puts "  IMAGE_ID_#{name} = #{i},"
+  }
+  file.puts "};"
+  file.puts
+  file.puts "#define IMAGE_TABLE_SIZE #{entries.size}"
+  file.puts "#endif"
+
+  file.close  if $options[:o]
+end
+
+
+##
+# main
+#
+$options = get_options()
+exit 1 if !$options
+
+images = fetch_images( $options[:i] )
+entries = images.map {|name| [name, name] }
+ALIAS.each {|name, image|
+  if !images.include?(image)
+    STDERR.puts "Alias '#{name}' refers to unknown image '#{image}'."
+    exit 1
+  end
+  entries << [name, image]
+}
+
+names = entries.map {|e| e[0] }
+if names.uniq.size != names.size
+  STDERR.puts "Duplicated image name(s): #{names.select {|n| names.count(n) > 1 }.uniq.join(", ")}"
+  exit 1
+end
+
+entries.sort_by! {|e| e[0].b }
+vp("#{entries.size} entries.")
+
+write_file( entries )
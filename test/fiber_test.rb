@@ -0,0 +1,101 @@
+# frozen_string_literal: true
+
+class FiberTest < MrubycTestCase
+
+  description "resume and yield pass values"
+  def resume_yield_case
+    f = Fiber.new do |x|
+      y = Fiber.yield(x + 1)
+      Fiber.yield(y + 10)
+      :done
+    end
+    assert_equal 2, f.resume(1)
+    assert_equal 15, f.resume(5)
+    assert_equal :done, f.resume
+    assert_false f.alive?
+  end
+
+  description "block sees the local variables of the method"
+  def local_variable_case
+    count = 0
+    f = Fiber.new do
+      while true do
+        count += 1
+        Fiber.yield
+      end
+    end
+    3.times { f.resume }
+    assert_equal 3, count
+    assert_true f.alive?
+  end
+
+  description "several fibers interleave"
+  def interleave_case
+    log = []
+    a = Fiber.new { 2.times {|i| log << "a#{i}"; Fiber.yield } }
+    b = Fiber.new { 2.times {|i| log << "b#{i}"; Fiber.yield } }
+    2.times { a.resume; b.resume }
+    assert_equal ["a0", "b0", "a1", "b1"], log
+  end
+
+  description "exception in the block raises in resume"
+  def exception_case
+    f = Fiber.new { raise "ERROR" }
+    v = nil
+    begin
+      f.resume
+    rescue
+      v = :ok_rescue
+    end
+    assert_equal :ok_rescue, v
+    assert_false f.alive?
+  end
+
+  description "block with more registers than a fiber has"
+  def too_many_registers_case
+    # no parameters, so no OP_ENTER to check the registers.
+    f = Fiber.new do
+      v00 = 0
+      v01 = 1
+      v02 = 2
+      v03 = 3
+      v04 = 4
+      v05 = 5
+      v06 = 6
+      v07 = 7
+      v08 = 8
+      v09 = 9
+      v10 = 10
+      v11 = 11
+      v12 = 12
+      v13 = 13
+      v14 = 14
+      v15 = 15
+      v16 = 16
+      v17 = 17
+      v18 = 18
+      v19 = 19
+      v20 = 20
+      v21 = 21
+      v22 = 22
+      v23 = 23
+      v24 = 24
+      v25 = 25
+      v26 = 26
+      v27 = 27
+      v28 = 28
+      v29 = 29
+      v30 = 30
+      v31 = 31
+      v32 = 32
+      v00 + v32
+    end
+    v = nil
+    begin
+      f.resume
+    rescue RuntimeError
+      v = :ok_rescue
+    end
+    assert_equal :ok_rescue, v
+  end
+end
@@ -489,4 +489,88 @@ class StringTest < MrubycTestCase
     assert_equal "str", "str".to_s
   end
 
+  description "modifying a string literal does not change the literal"
+  def literal_copy_on_write_case
+    3.times do
+      s = "abc"
+      assert_equal "abc", s
+      s << "d"
+      s.slice!(0)
+      s.tr!("c", "x")
+      assert_equal "bxd", s
+    end
+  end
+
+  description "substring view"
+  def substring_view_case
+    s = "0123456789" * 4
+    a = s.split("5")
+    t = s[2, 30]
+    s << "!"
+    s[0] = "X"
+    assert_equal "X123456789012345678901234567890123456789!", s
+    assert_equal "01234", a[0]
+    assert_equal "678901234", a[1]
+    assert_equal "234567890123456789012345678901", t
+    t << "?"
+    assert_equal "234567890123456789012345678901?", t
+    assert_equal "6789", a[4]
+  end
+
+  description "reading a substring view"
+  def substring_view_read_case
+    s = "12,34.5,abc,1f"
+    a = s.split(",")
+    assert_equal 12, a[0].to_i
+    assert_equal 34, a[1].to_i
+    assert_equal 34.5, a[1].to_f
+    assert_equal 31, a[3].to_i(16)
+    assert_equal :abc, a[2].to_sym
+    assert_equal :ab, s[8, 2].to_sym
+    assert_equal 1, s[0, 1].to_i
+    assert_equal "34", sprintf("%d", a[1])
+    assert_equal "12,34.5,abc,1f", s
+  end
+
+  # "+" makes a new string, which is inline when it is shorter than
+  # MRBC_STRING_INLINE_SIZE (16).
+  description "inline string grows to the heap"
+  def inline_to_heap_case
+    s = "0123456" + "7890123"
+    d = s.dup
+    s << "4"
+    assert_equal "012345678901234", s
+    s << "5"
+    assert_equal "0123456789012345", s
+    s << "6789"
+    assert_equal "01234567890123456789", s
+    assert_equal "01234567890123", d
+
+    s = "abc" + "def"
+    s[1] = "0123456789ABCDEF"
+    assert_equal "a0123456789ABCDEFcdef", s
+
+    s = "abc" + "def"
+    s[6, 0] = "0123456789"
+    assert_equal "abcdef0123456789", s
+
+    s = "abc" + "def"
+    s[0, 6] = "0123456789abcdefg"
+    assert_equal "0123456789abcdefg", s
+  end
+
+  description "inline string shrinks in place, then grows"
+  def inline_shrink_grow_case
+    s = "  abc" + "  "
+    s.strip!
+    assert_equal "abc", s
+    s << "defghijklmnopqrstu"
+    assert_equal "abcdefghijklmnopqrstu", s
+
+    s = "xy" + "z"
+    s.slice!(0)
+    s[0, 0] = "0123456789012345"
+    assert_equal "0123456789012345yz", s
+  end
+
 end